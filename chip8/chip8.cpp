@@ -1,19 +1,61 @@
 #include <chip8/chip8.h>
+#include <quirks.h>
 
 #include <gsl/gsl>
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 int main(int argc, char **argv) {
     if (argc < 2) {
-        std::cout << "USAGE: chip8 romfile" << std::endl;
+        std::cout << "USAGE: chip8 romfile [instructions_per_frame [--unthrottled] [--run-ahead=frames] [--record=movie [--keyframes=frames]] [--quirks=chip8|vip|schip|xochip] [--rom-db=file]]" << std::endl;
         return -1;
     }
 
     [[maybe_unused]] auto args = gsl::make_span(argv, argc);
 
+    RunOptions options;
     try {
-        run_chip8(gsl::at(args, 1));
+        if (argc > 2) {
+            options.instr_per_frame = std::stoul(gsl::at(args, 2));
+        }
+        for (int i = 3; i < argc; ++i) {
+            const std::string flag = gsl::at(args, i);
+            const std::string run_ahead = "--run-ahead=";
+            const std::string record = "--record=";
+            const std::string keyframes = "--keyframes=";
+            const std::string quirks = "--quirks=";
+            const std::string rom_db = "--rom-db=";
+            if (flag == "--unthrottled") {
+                options.throttle = false;
+            } else if (flag.starts_with(run_ahead)) {
+                options.run_ahead = std::stoul(flag.substr(run_ahead.size()));
+            } else if (flag.starts_with(record)) {
+                options.movie = flag.substr(record.size());
+            } else if (flag.starts_with(keyframes)) {
+                options.movie_keyframes = std::stoul(flag.substr(keyframes.size()));
+            } else if (flag.starts_with(quirks)) {
+                auto profile = parse_quirk_profile(flag.substr(quirks.size()));
+                if (!profile) {
+                    std::cerr << "unknown quirk profile " << flag.substr(quirks.size()) << std::endl;
+                    return -1;
+                }
+                options.quirks = *profile;
+            } else if (flag.starts_with(rom_db)) {
+                options.rom_db = flag.substr(rom_db.size());
+            } else {
+                std::cerr << "unknown option " << flag << std::endl;
+                return -1;
+            }
+        }
+    } catch (std::logic_error &) {
+        std::cerr << "instructions_per_frame, run-ahead and keyframe frames must be numbers" << std::endl;
+        return -1;
+    }
+
+    try {
+        run_chip8(gsl::at(args, 1), options);
         // run_chip8("roms/IBM_Logo.ch8");
     } catch (std::runtime_error &e) {
         std::cerr << e.what() << std::endl;
@@ -1,8 +1,111 @@
 #ifndef C8_CHIP8_H
 #define C8_CHIP8_H
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
 
-void run_chip8(const std::filesystem::path &);
+// behaviour of the chip8 interpreter a rom was written for, see quirks.h
+enum class QuirkProfile : std::uint8_t {
+    Chip8,     // what this emulator always did
+    CosmacVip, // the original interpreter
+    SuperChip, // SUPER-CHIP 1.1 on the HP48
+    XoChip,    // Octo and XO-CHIP
+};
+
+struct RunOptions {
+    // 0 runs against the wall clock, otherwise time is virtual and every
+    // 60 Hz frame runs exactly this many instructions
+    unsigned int instr_per_frame = 0;
+    // with virtual time, wait for vsync between frames instead of running
+    // as fast as the host can
+    bool throttle = true;
+    // with virtual time, present the screen this many frames ahead of the
+    // machine to hide input latency
+    unsigned int run_ahead = 0;
+    // with virtual time, record the input into this movie file for
+    // chip8_replay, unless empty. Rewinding is off while recording
+    std::filesystem::path movie;
+    // frames between the snapshots embedded into the movie for seeking and
+    // parallel verification, 0 for none
+    unsigned int movie_keyframes = 0;
+    // unset takes the quirks, and with the wall clock the speed, the rom
+    // database has for the rom, chip8 for roms it does not know
+    std::optional<QuirkProfile> quirks;
+    // override file layered on top of the built-in rom database, see rom_db.h
+    std::filesystem::path rom_db;
+};
+
+// opens a window and runs the rom until it is closed
+void run_chip8(const std::filesystem::path &, const RunOptions &options = {});
+
+// read-only view of a machine's screen. Every row is words_per_row 64 bit
+// words, the leftmost pixel in the most significant bit of the first one
+struct ScreenView {
+    std::span<const std::uint64_t> words;
+    unsigned int width;
+    unsigned int height;
+
+    [[nodiscard]] inline unsigned int words_per_row() const noexcept {
+        return width / 64;
+    }
+
+    [[nodiscard]] inline bool is_set(unsigned int x, unsigned int y) const noexcept {
+        return (words[y * words_per_row() + x / 64] >> (63 - x % 64) & 1) != 0;
+    }
+};
+
+// read-only view of a machine's registers, stack and memory
+struct MachineState {
+    std::span<const std::uint8_t> v; // V0 to VF
+    std::uint16_t pc;
+    std::uint16_t index;
+    std::uint8_t delay_timer;
+    std::uint8_t sound_timer;
+    std::span<const std::uint16_t> stack; // return addresses, the top last
+    std::span<const std::uint8_t> memory;
+    bool trapped; // stack overflow or underflow at pc or 00FD exit, nothing runs anymore
+};
+
+// one headless machine driven by the host, no window and no wall clock.
+// Nothing is copied to read it: the spans of a view point into the machine
+// and follow it for as long as it lives, only the other fields and the depth
+// of the stack are as of the call
+class Machine {
+  public:
+    // copies rom into the machine, throws std::runtime_error if it does not
+    // fit. 0 instructions per frame keeps the default of 500 per second
+    explicit Machine(std::span<const std::uint8_t> rom, unsigned int instr_per_frame = 0, QuirkProfile quirks = QuirkProfile::Chip8);
+    ~Machine();
+
+    Machine(const Machine &) = delete;
+    Machine &operator=(const Machine &) = delete;
+
+    Machine(Machine &&) noexcept;
+    Machine &operator=(Machine &&) noexcept;
+
+    // run count instructions, the delay and sound timers ticking at 60 Hz of
+    // emulated time. Returns how many ran, fewer after a trap or while a
+    // draw waits for the next 60 Hz tick under CosmacVip quirks
+    unsigned int step(unsigned int count);
+    // run frames 60 Hz frames, returns how many instructions ran
+    unsigned int run_frames(unsigned int frames);
+
+    // bit n set while key n is held
+    void set_keys(std::uint16_t mask) noexcept;
+    // restart the random number generator from seed, for reproducible runs
+    void seed(std::uint32_t seed) noexcept;
+
+    // 64x32, or 128x64 after a SUPER-CHIP rom switched to high resolution.
+    // A view taken before the resolution changes shows the old screen
+    [[nodiscard]] ScreenView screen() const noexcept;
+    [[nodiscard]] MachineState state() const noexcept;
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
 
 #endif
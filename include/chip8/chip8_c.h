@@ -0,0 +1,88 @@
+#ifndef C8_CHIP8_C_H
+#define C8_CHIP8_C_H
+
+/* C interface of libchip8 (the chip8_shared target) for hosts in other
+ * languages. Only plain C types cross it: no exceptions escape, errors are
+ * returned as chip8_status codes. Bump CHIP8_ABI_VERSION on every change
+ * that breaks callers built against an older version. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(CHIP8_BUILDING_SHARED)
+#define CHIP8_API __declspec(dllexport)
+#else
+#define CHIP8_API __declspec(dllimport)
+#endif
+#else
+#define CHIP8_API __attribute__((visibility("default")))
+#endif
+
+#define CHIP8_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct chip8_machine chip8_machine;
+
+typedef enum chip8_status {
+    CHIP8_OK = 0,
+    CHIP8_INVALID_ARGUMENT,
+    CHIP8_ROM_TOO_LARGE,
+    CHIP8_BUFFER_TOO_SMALL,
+    CHIP8_INCOMPATIBLE_STATE, /* saved by another version or build, or corrupted */
+    CHIP8_OUT_OF_MEMORY,
+} chip8_status;
+
+/* behaviour of the interpreter a rom was written for, same values as
+ * QuirkProfile in chip8.h */
+typedef enum chip8_quirks {
+    CHIP8_QUIRKS_CHIP8 = 0,
+    CHIP8_QUIRKS_COSMAC_VIP,
+    CHIP8_QUIRKS_SUPER_CHIP,
+    CHIP8_QUIRKS_XO_CHIP,
+} chip8_quirks;
+
+/* CHIP8_ABI_VERSION of the loaded library */
+CHIP8_API uint32_t chip8_abi_version(void);
+
+/* a machine with rom copied into its memory, running instr_per_frame
+ * instructions per 60 Hz frame, or 500 per second for 0 */
+CHIP8_API chip8_status chip8_create(const uint8_t *rom, size_t rom_size, unsigned int instr_per_frame, chip8_machine **machine);
+/* chip8_create with the quirks of another interpreter than CHIP8_QUIRKS_CHIP8 */
+CHIP8_API chip8_status chip8_create_with_quirks(const uint8_t *rom, size_t rom_size, unsigned int instr_per_frame, chip8_quirks quirks, chip8_machine **machine);
+CHIP8_API void chip8_destroy(chip8_machine *machine);
+
+/* run count instructions or frames 60 Hz frames, the delay and sound timers
+ * ticking at 60 Hz of emulated time. Return how many instructions ran,
+ * fewer only once the machine trapped */
+CHIP8_API unsigned int chip8_step(chip8_machine *machine, unsigned int count);
+CHIP8_API unsigned int chip8_run_frames(chip8_machine *machine, unsigned int frames);
+
+/* bit n set while key n is held */
+CHIP8_API void chip8_set_keys(chip8_machine *machine, uint16_t mask);
+/* restart the random number generator from seed, for reproducible runs */
+CHIP8_API void chip8_seed(chip8_machine *machine, uint32_t seed);
+/* nonzero after a stack overflow or underflow or a 00FD exit, nothing runs
+ * anymore */
+CHIP8_API int chip8_is_trapped(const chip8_machine *machine);
+
+/* the screen, 64x32 or 128x64 in SUPER-CHIP high resolution, valid until the
+ * resolution changes. Every row is width / 64 words, the leftmost pixel in
+ * the most significant bit of the first one */
+CHIP8_API const uint64_t *chip8_framebuffer(const chip8_machine *machine, unsigned int *width, unsigned int *height);
+
+/* bytes a saved state takes */
+CHIP8_API size_t chip8_state_size(void);
+/* copy the whole machine into buffer, which needs chip8_state_size() bytes */
+CHIP8_API chip8_status chip8_save_state(const chip8_machine *machine, void *buffer, size_t size);
+/* continue from a state saved by chip8_save_state of the same library */
+CHIP8_API chip8_status chip8_load_state(chip8_machine *machine, const void *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
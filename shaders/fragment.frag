@@ -1,8 +1,9 @@
-#version 460 core
+#version 450 core
+in vec2 uv;
 out vec4 FragColor;
 
-uniform vec3 color;
+uniform sampler2D screen;
 
 void main() {
-    FragColor = vec4(color, 1.0f);
+    FragColor = vec4(vec3(texture(screen, uv).r), 1.0f);
 }
@@ -1,9 +1,10 @@
-#version 460 core
+#version 450 core
 layout (location = 0) in vec3 pos;
 
-uniform mat4 model;
+out vec2 uv;
 
 void main() {
-    gl_Position = model * vec4(pos, 1.0f);
+    // texture row 0 is the top of the screen
+    uv = vec2(pos.x + 1.0f, 1.0f - pos.y) * 0.5f;
+    gl_Position = vec4(pos, 1.0f);
 }
-
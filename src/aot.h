@@ -0,0 +1,47 @@
+#ifndef C8_AOT_H
+#define C8_AOT_H
+
+#include "call_stack.h"
+#include "common.h"
+#include "cpu.h"
+#include "framebuffer.h"
+#include "frontend.h"
+#include "ram.h"
+#include "registers.h"
+
+#include <gsl/gsl>
+
+#include <bitset>
+
+// machine state handed to a rom translated ahead of time by chip8_translate
+struct AotMachine {
+    Registers &regs;
+    RAM<> &memory;
+    Framebuffer &framebuffer;
+    const Frontend &frontend;
+    CallStack<> &stack;
+    Rng &rng;
+    i8 &key_pressed;
+    RplFlags &flags;
+
+    // addresses written since the rom was loaded. The translation of an
+    // instruction is only valid while neither of its bytes was written
+    const std::bitset<default_memory_size> &written;
+
+    [[nodiscard]] inline bool is_written(u16 pc) const {
+        return written.test(pc) || written.test(pc + 1);
+    }
+};
+
+// runs at most budget instructions starting at regs.get_pc() and returns how
+// many were executed. Returns early with the pc set to the instruction the
+// interpreter has to execute next.
+using AotProgram = unsigned int (*)(AotMachine &machine, unsigned int budget);
+
+// defined by the translation unit chip8_translate generates
+[[nodiscard]] gsl::span<const u8> translated_rom() noexcept;
+// the profile the rom was translated for, the CPU has to run with it
+[[nodiscard]] QuirkProfile translated_quirks() noexcept;
+unsigned int translated_program(AotMachine &machine, unsigned int budget);
+
+#endif
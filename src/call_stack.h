@@ -0,0 +1,75 @@
+#ifndef C8_CALL_STACK_H
+#define C8_CALL_STACK_H
+
+#include "common.h"
+
+#include <gsl/gsl>
+
+#include <array>
+
+constexpr u8 chip8_stack_depth = 16;
+
+// why the machine stopped executing instructions
+enum class Trap : u8 {
+    None,
+    StackOverflow,  // 2NNN with every entry in use
+    StackUnderflow, // 00EE with no entry in use
+    Exit,           // 00FD, the rom is done
+};
+
+[[nodiscard]] constexpr const char *trap_name(Trap trap) noexcept {
+    switch (trap) {
+        case (Trap::StackOverflow):
+            return "stack overflow";
+        case (Trap::StackUnderflow):
+            return "stack underflow";
+        case (Trap::Exit):
+            return "exit";
+        default:
+            return "none";
+    }
+}
+
+// trap and the address of the instruction that raised it
+struct CpuTrap {
+    Trap kind = Trap::None;
+    u16 pc = 0;
+};
+
+// return addresses of 2NNN, stored inline so that it never allocates
+template <u8 Depth = chip8_stack_depth>
+class CallStack {
+  public:
+    static constexpr u8 depth = Depth;
+
+    [[nodiscard]] inline Trap push(u16 addr) noexcept {
+        if (m_sp == Depth) {
+            return Trap::StackOverflow;
+        }
+        m_entries[m_sp++] = addr;
+        return Trap::None;
+    }
+
+    [[nodiscard]] inline Trap pop(u16 &addr) noexcept {
+        if (m_sp == 0) {
+            return Trap::StackUnderflow;
+        }
+        addr = m_entries[--m_sp];
+        return Trap::None;
+    }
+
+    // entries in use, the last one is the top of the stack
+    [[nodiscard]] inline gsl::span<const u16> entries() const noexcept {
+        return gsl::span<const u16>(m_entries).first(m_sp);
+    }
+
+    [[nodiscard]] inline u8 sp() const noexcept {
+        return m_sp;
+    }
+
+  private:
+    std::array<u16, Depth> m_entries{};
+    u8 m_sp = 0;
+};
+
+#endif
@@ -1,16 +1,149 @@
 #include <chip8/chip8.h>
 
 #include "cpu.h"
+#include "display.h"
+#include "movie.h"
+#include "ram.h"
+#include "rom_db.h"
+#include "rewind.h"
+#include "run_ahead.h"
+#include "snapshot.h"
 
-void run_chip8(const std::filesystem::path &rom_file) {
-    CPU cpu(rom_file);
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 
+namespace {
+// a 00FD exit is the rom ending, every other trap an error
+void check_trap(const CPU &cpu) {
+    if (cpu.is_trapped() && cpu.trap().kind != Trap::Exit) {
+        std::ostringstream message;
+        message << trap_name(cpu.trap().kind) << " at 0x" << std::hex << cpu.trap().pc;
+        throw std::runtime_error(message.str());
+    }
+}
+
+// while backspace is held every host frame steps one recorded frame back
+class Rewinder {
+  public:
+    Rewinder() : m_snapshot(std::make_unique<Snapshot>()) {}
+
+    // true when this frame was spent rewinding instead of running
+    bool rewind(CPU &cpu, Display &display) {
+        if (!display.is_rewinding()) {
+            return false;
+        }
+        if (m_buffer.rewind(1, *m_snapshot)) {
+            cpu.load(*m_snapshot);
+        }
+        display.present(cpu.framebuffer());
+        display.poll_events();
+        return true;
+    }
+
+    void record(const CPU &cpu) {
+        cpu.save(*m_snapshot);
+        m_buffer.record(*m_snapshot);
+    }
+
+    void record(const Snapshot &snapshot) {
+        m_buffer.record(snapshot);
+    }
+
+  private:
+    RewindBuffer m_buffer;
+    std::unique_ptr<Snapshot> m_snapshot;
+};
+} // namespace
+
+void run_chip8(const std::filesystem::path &rom_file, const RunOptions &options) {
+    if (!options.movie.empty() && options.instr_per_frame == 0) {
+        throw std::runtime_error("recording a movie needs a fixed number of instructions per frame");
+    }
+
+    auto rom = read_rom_file(rom_file);
+    RomDatabase database;
+    if (!options.rom_db.empty()) {
+        database.load_overrides(options.rom_db);
+    }
+    auto info = database.find(rom).value_or(RomInfo{});
+    auto quirks = options.quirks.value_or(info.quirks);
+
+    Display display;
+    CPU cpu(rom, display, default_dispatch, quirks);
+    Rewinder rewinder;
+    rewinder.record(cpu);
+
+    if (options.instr_per_frame > 0) {
+        // virtual time, the wall clock only paces frames through vsync
+        cpu.set_instr_per_frame(options.instr_per_frame);
+        display.set_vsync(options.throttle);
+        RunAhead run_ahead(options.run_ahead);
+
+        std::optional<Movie> movie;
+        if (!options.movie.empty()) {
+            movie.emplace(rom, std::random_device{}(), options.instr_per_frame, options.movie_keyframes, quirks);
+            prepare_replay(*movie, cpu);
+        }
+
+        while (!cpu.should_terminate() && !cpu.is_trapped()) {
+            if (!movie && rewinder.rewind(cpu, display)) {
+                continue;
+            }
+            // keys only change when polling, cpu.run_frame polls after the
+            // frame, run-ahead before it
+            if (options.run_ahead > 0) {
+                display.poll_events();
+            }
+            if (movie) {
+                movie->record(cpu, key_mask(display));
+            }
+            if (options.run_ahead > 0) {
+                run_ahead.run_frame(cpu, display);
+                rewinder.record(run_ahead.snapshot());
+            } else {
+                cpu.run_frame();
+                rewinder.record(cpu);
+            }
+        }
+
+        // kept even when the rom trapped, the movie reproduces the trap
+        if (movie) {
+            auto final_state = std::make_unique<Snapshot>();
+            cpu.save(*final_state);
+            movie->finish(*final_state);
+            movie->save(options.movie);
+        }
+        check_trap(cpu);
+        return;
+    }
+
+    // the speed the rom database knows for the rom, against the wall clock
+    if (info.instr_per_frame > 0) {
+        cpu.set_instr_per_frame(info.instr_per_frame);
+    }
+
+    // one iteration per host frame: run the instructions due, then present
+    // and poll once, the buffer swap waits for vsync
     auto current_time = glfwGetTime();
-    while (!cpu.should_terminate()) {
+    while (!cpu.should_terminate() && !cpu.is_trapped()) {
         auto new_time = glfwGetTime();
         auto frame_time = new_time - current_time;
         current_time = new_time;
+        if (rewinder.rewind(cpu, display)) {
+            continue;
+        }
 
-        cpu.instr_cycle(frame_time);
+        [[maybe_unused]] auto report = cpu.instr_cycle(frame_time);
+#ifdef CH_DEBUG
+        if (report.dropped > 0) {
+            std::cerr << "host fell behind, dropped " << report.dropped << "s" << std::endl;
+        }
+#endif
+        check_trap(cpu);
+        rewinder.record(cpu);
     }
 }
@@ -0,0 +1,136 @@
+#include <chip8/chip8_c.h>
+
+#include "cpu.h"
+#include "null_frontend.h"
+#include "quirks.h"
+#include "snapshot.h"
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+struct chip8_machine {
+    chip8_machine(gsl::span<const u8> rom, QuirkProfile quirks) : cpu(rom, frontend, default_dispatch, quirks) {}
+
+    NullFrontend frontend;
+    CPU cpu;
+};
+
+static_assert(CHIP8_QUIRKS_COSMAC_VIP == static_cast<int>(QuirkProfile::CosmacVip) && CHIP8_QUIRKS_SUPER_CHIP == static_cast<int>(QuirkProfile::SuperChip) && CHIP8_QUIRKS_XO_CHIP == static_cast<int>(QuirkProfile::XoChip), "chip8_quirks mirrors QuirkProfile");
+
+// exceptions must not unwind into C, every call that can throw catches them
+uint32_t chip8_abi_version(void) {
+    return CHIP8_ABI_VERSION;
+}
+
+chip8_status chip8_create(const uint8_t *rom, size_t rom_size, unsigned int instr_per_frame, chip8_machine **machine) {
+    return chip8_create_with_quirks(rom, rom_size, instr_per_frame, CHIP8_QUIRKS_CHIP8, machine);
+}
+
+chip8_status chip8_create_with_quirks(const uint8_t *rom, size_t rom_size, unsigned int instr_per_frame, chip8_quirks quirks, chip8_machine **machine) {
+    if ((rom == nullptr && rom_size > 0) || machine == nullptr || static_cast<unsigned int>(quirks) >= quirk_profile_count) {
+        return CHIP8_INVALID_ARGUMENT;
+    }
+
+    *machine = nullptr;
+    try {
+        auto created = std::make_unique<chip8_machine>(gsl::span<const u8>(rom, rom_size), static_cast<QuirkProfile>(quirks));
+        if (instr_per_frame > 0) {
+            created->cpu.set_instr_per_frame(instr_per_frame);
+        }
+        *machine = created.release();
+        return CHIP8_OK;
+    } catch (std::bad_alloc &) {
+        return CHIP8_OUT_OF_MEMORY;
+    } catch (std::exception &) {
+        return CHIP8_ROM_TOO_LARGE;
+    }
+}
+
+void chip8_destroy(chip8_machine *machine) {
+    delete machine;
+}
+
+unsigned int chip8_step(chip8_machine *machine, unsigned int count) {
+    return machine->cpu.run(count);
+}
+
+unsigned int chip8_run_frames(chip8_machine *machine, unsigned int frames) {
+    unsigned int executed = 0;
+    for (unsigned int frame = 0; frame < frames && !machine->cpu.is_trapped(); ++frame) {
+        executed += machine->cpu.step_frame();
+    }
+    return executed;
+}
+
+void chip8_set_keys(chip8_machine *machine, uint16_t mask) {
+    machine->frontend.set_keys(mask);
+}
+
+void chip8_seed(chip8_machine *machine, uint32_t seed) {
+    machine->cpu.seed(seed);
+}
+
+int chip8_is_trapped(const chip8_machine *machine) {
+    return machine->cpu.is_trapped() ? 1 : 0;
+}
+
+const uint64_t *chip8_framebuffer(const chip8_machine *machine, unsigned int *width, unsigned int *height) {
+    const auto &framebuffer = machine->cpu.framebuffer();
+    if (width != nullptr) {
+        *width = framebuffer.width();
+    }
+    if (height != nullptr) {
+        *height = framebuffer.height();
+    }
+    return framebuffer.words().data();
+}
+
+size_t chip8_state_size(void) {
+    return sizeof(Snapshot);
+}
+
+// the caller's buffer may not be aligned for a Snapshot, go through a copy
+chip8_status chip8_save_state(const chip8_machine *machine, void *buffer, size_t size) {
+    if (buffer == nullptr) {
+        return CHIP8_INVALID_ARGUMENT;
+    }
+    if (size < sizeof(Snapshot)) {
+        return CHIP8_BUFFER_TOO_SMALL;
+    }
+
+    auto snapshot = std::unique_ptr<Snapshot>(new (std::nothrow) Snapshot());
+    if (!snapshot) {
+        return CHIP8_OUT_OF_MEMORY;
+    }
+    machine->cpu.save(*snapshot);
+    std::memcpy(buffer, snapshot.get(), sizeof(Snapshot));
+    return CHIP8_OK;
+}
+
+chip8_status chip8_load_state(chip8_machine *machine, const void *buffer, size_t size) {
+    if (buffer == nullptr) {
+        return CHIP8_INVALID_ARGUMENT;
+    }
+    if (size < sizeof(Snapshot)) {
+        return CHIP8_BUFFER_TOO_SMALL;
+    }
+
+    auto snapshot = std::unique_ptr<Snapshot>(new (std::nothrow) Snapshot());
+    if (!snapshot) {
+        return CHIP8_OUT_OF_MEMORY;
+    }
+    try {
+        snapshot_from_bytes(gsl::span<const u8>(static_cast<const u8 *>(buffer), sizeof(Snapshot)), *snapshot);
+        if (!CPU::is_valid(*snapshot)) {
+            return CHIP8_INCOMPATIBLE_STATE;
+        }
+        machine->cpu.load(*snapshot);
+        return CHIP8_OK;
+    } catch (std::bad_alloc &) {
+        return CHIP8_OUT_OF_MEMORY;
+    } catch (std::exception &) {
+        return CHIP8_INCOMPATIBLE_STATE;
+    }
+}
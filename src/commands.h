@@ -1,78 +1,263 @@
 #ifndef C8_COMMANDS_H
 #define C8_COMMANDS_H
 
+#include "call_stack.h"
 #include "common.h"
 #include "cpu.h"
-#include "display.h"
+#include "decoder.h"
+#include "framebuffer.h"
+#include "frontend.h"
+#include "quirks.h"
 #include "ram.h"
 #include "registers.h"
 
-#include <stack>
-
+// commands whose behaviour differs between interpreters take the Quirks
+// policy of the profile they run under as template parameter
 namespace commands {
 
-void clear_or_return(const Opcode &op, Display &display, std::stack<u16> &stack, Registers &regs);
+inline constexpr u8 flag_register = 0xf;
+
+inline void clear(Framebuffer &framebuffer) noexcept {
+    framebuffer.clear();
+}
+
+// 00CN, 00FB and 00FC, in pixels of the current resolution
+inline void scroll_down(const Instruction &op, Framebuffer &framebuffer) noexcept {
+    framebuffer.scroll_down(op.n);
+}
+
+inline void scroll_right(Framebuffer &framebuffer) noexcept {
+    framebuffer.scroll_right();
+}
 
-inline void jump(const Opcode &op, Registers &regs) noexcept {
-    regs.set_pc(op.get_12bits());
+inline void scroll_left(Framebuffer &framebuffer) noexcept {
+    framebuffer.scroll_left();
 }
 
-inline void call(const Opcode &op, std::stack<u16> &stack, Registers &regs) {
-    stack.push(regs.get_pc());
-    regs.set_pc(op.get_12bits());
+// 00FE and 00FF
+inline void set_high_res(Framebuffer &framebuffer, bool high_res) noexcept {
+    framebuffer.set_high_res(high_res);
+}
+
+[[nodiscard]] inline Trap ret(CallStack<> &stack, Registers &regs) noexcept {
+    u16 addr = 0;
+    auto trap = stack.pop(addr);
+    if (trap == Trap::None) {
+        regs.set_pc(addr);
+    }
+    return trap;
+}
+
+inline void jump(const Instruction &op, Registers &regs) noexcept {
+    regs.set_pc(op.nnn);
+}
+
+[[nodiscard]] inline Trap call(const Instruction &op, CallStack<> &stack, Registers &regs) noexcept {
+    auto trap = stack.push(regs.get_pc());
+    if (trap == Trap::None) {
+        regs.set_pc(op.nnn);
+    }
+    return trap;
+}
+
+inline void if_reg_not_eq_value(const Instruction &op, Registers &regs) noexcept {
+    if (regs.at(op.x) == op.nn) {
+        regs.incr_pc();
+    }
 }
 
-inline void if_reg_not_eq_value(const Opcode &op, Registers &regs) noexcept {
-    if (regs.at(op.get_nibble(2)) == op.get_byte(0)) {
+inline void if_reg_eq_value(const Instruction &op, Registers &regs) noexcept {
+    if (regs.at(op.x) != op.nn) {
         regs.incr_pc();
     }
 }
 
-inline void if_reg_eq_value(const Opcode &op, Registers &regs) noexcept {
-    if (regs.at(op.get_nibble(2)) != op.get_byte(0)) {
+inline void if_reg_not_eq_reg(const Instruction &op, Registers &regs) noexcept {
+    if (regs.at(op.x) == regs.at(op.y)) {
         regs.incr_pc();
     }
 }
 
-inline void if_reg_not_eq_reg(const Opcode &op, Registers &regs) noexcept {
-    if (regs.at(op.get_nibble(2)) == regs.at(op.get_nibble(1))) {
+inline void set_reg_value(const Instruction &op, Registers &regs) noexcept {
+    regs.at(op.x) = op.nn;
+}
+
+inline void add_to_reg(const Instruction &op, Registers &regs) noexcept {
+    regs.at(op.x) += op.nn;
+}
+
+// 8XY_ register operations
+inline void set(const Instruction &op, Registers &regs) noexcept {
+    regs.at(op.x) = regs.at(op.y);
+}
+
+template <typename Q>
+inline void bitwise_or(const Instruction &op, Registers &regs) noexcept {
+    regs.at(op.x) |= regs.at(op.y);
+    if constexpr (Q::set.vf_reset) {
+        regs.at(flag_register) = 0;
+    }
+}
+
+template <typename Q>
+inline void bitwise_and(const Instruction &op, Registers &regs) noexcept {
+    regs.at(op.x) &= regs.at(op.y);
+    if constexpr (Q::set.vf_reset) {
+        regs.at(flag_register) = 0;
+    }
+}
+
+template <typename Q>
+inline void bitwise_xor(const Instruction &op, Registers &regs) noexcept {
+    regs.at(op.x) ^= regs.at(op.y);
+    if constexpr (Q::set.vf_reset) {
+        regs.at(flag_register) = 0;
+    }
+}
+
+void addition(const Instruction &op, Registers &regs) noexcept;
+void subtraction(const Instruction &op, Registers &regs) noexcept;
+void alt_subtraction(const Instruction &op, Registers &regs) noexcept;
+
+// vx >> 1 and set vf to the bit shifted out
+template <typename Q>
+inline void shift_right(const Instruction &op, Registers &regs) noexcept {
+    auto &vx = regs.at(op.x);
+    if constexpr (Q::set.shift_vy) {
+        vx = regs.at(op.y);
+    }
+    auto flag = vx & 0x1;
+
+    vx >>= 1;
+    regs.at(flag_register) = flag;
+}
+
+// vx << 1 and set vf to the bit shifted out
+template <typename Q>
+inline void shift_left(const Instruction &op, Registers &regs) noexcept {
+    auto &vx = regs.at(op.x);
+    if constexpr (Q::set.shift_vy) {
+        vx = regs.at(op.y);
+    }
+    auto flag = vx >> 7;
+
+    vx <<= 1;
+    regs.at(flag_register) = flag;
+}
+
+inline void if_reg_eq_reg(const Instruction &op, Registers &regs) noexcept {
+    if (regs.at(op.x) != regs.at(op.y)) {
         regs.incr_pc();
     }
 }
 
-inline void set_reg_value(const Opcode &op, Registers &regs) noexcept {
-    auto reg = op.get_nibble(2);
-    regs.at(reg) = op.get_byte(0);
+inline void set_index(const Instruction &op, Registers &regs) noexcept {
+    regs.set_index(op.nnn);
 }
 
-inline void add_to_reg(const Opcode &op, Registers &regs) noexcept {
-    auto reg = op.get_nibble(2);
-    regs.at(reg) += op.get_byte(0);
+// BNNN, or BXNN with the jump_vx quirk
+template <typename Q>
+inline void jump_add_plus_v0(const Instruction &op, Registers &regs) noexcept {
+    if constexpr (Q::set.jump_vx) {
+        regs.set_pc(op.nnn + regs.at(op.x));
+    } else {
+        regs.set_pc(op.nnn + regs.at(0x0));
+    }
 }
 
-void reg_operations(const Opcode &op, Registers &regs) noexcept;
-inline void if_reg_eq_reg(const Opcode &op, Registers &regs) noexcept {
-    if (regs.at(op.get_nibble(2)) != regs.at(op.get_nibble(1))) {
+inline void random_number(const Instruction &op, Registers &regs, Rng &rng) noexcept {
+    u8 rand_num = rng.gen() & op.nn;
+    regs.at(op.x) = rand_num;
+}
+
+// DXYN, or a 16x16 sprite for DXY0
+template <typename Q>
+inline void load_sprite(const Instruction &op, Registers &regs, RAM<> &memory, Framebuffer &framebuffer) noexcept {
+    auto x = regs.at(op.x);
+    auto y = regs.at(op.y);
+
+    bool has_flipped = false;
+    if (op.n == 0) {
+        has_flipped = framebuffer.draw_large_sprite<Q::set.wrap_sprites>(memory.get_sprite(regs.get_index(), large_sprite_size), x, y);
+    } else {
+        has_flipped = framebuffer.draw_sprite<Q::set.wrap_sprites>(memory.get_sprite(regs.get_index(), op.n), x, y);
+    }
+
+    regs.at(flag_register) = static_cast<u8>(has_flipped);
+}
+
+// EX9E and EXA1
+inline void if_key_not_pressed(const Instruction &op, Registers &regs, const Frontend &frontend) noexcept {
+    if (frontend.is_pressed(regs.at(op.x))) {
         regs.incr_pc();
     }
 }
 
-inline void set_index(const Opcode &op, Registers &regs) noexcept {
-    regs.set_index(op.get_12bits());
+inline void if_key_pressed(const Instruction &op, Registers &regs, const Frontend &frontend) noexcept {
+    if (!frontend.is_pressed(regs.at(op.x))) {
+        regs.incr_pc();
+    }
+}
+
+// FX__ operations
+inline void set_vx_delay(const Instruction &op, Registers &regs) noexcept {
+    regs.at(op.x) = regs.get_timer();
 }
 
-void jump_add_plus_v0(const Opcode &op, Registers &regs) noexcept;
+void set_vx_key(const Instruction &op, Registers &regs, const Frontend &frontend, i8 &key_pressed) noexcept;
 
-inline void random_number(const Opcode &op, Registers &regs, Rng &rng) noexcept {
-    u8 rand_num = rng.gen() & op.get_byte(0);
-    regs.at(op.get_nibble(2)) = rand_num;
+inline void set_delay(const Instruction &op, Registers &regs) noexcept {
+    regs.set_timer(regs.at(op.x));
 }
 
-void load_sprite(const Opcode &op, Registers &regs, RAM<> &memory, Display &display) noexcept;
+inline void set_buzzer(const Instruction &op, Registers &regs) noexcept {
+    regs.set_sound(regs.at(op.x));
+}
 
-void key_press_operations(const Opcode &op, Registers &regs, Display &display) noexcept;
+inline void add_vx_to_index(const Instruction &op, Registers &regs) noexcept {
+    regs.add_index(regs.at(op.x));
+}
+
+inline void set_index_to_hex(const Instruction &op, Registers &regs, const RAM<> &memory) noexcept {
+    regs.set_index(memory.get_font_addr(regs.at(op.x)));
+}
+
+inline void set_index_to_big_hex(const Instruction &op, Registers &regs, const RAM<> &memory) noexcept {
+    regs.set_index(memory.get_big_font_addr(regs.at(op.x)));
+}
+
+inline void bcd_vx(const Instruction &op, Registers &regs, RAM<> &memory) noexcept {
+    memory.store_bcd(regs.get_index(), regs.at(op.x));
+}
+
+template <typename Q>
+inline void store_to_ram(const Instruction &op, Registers &regs, RAM<> &memory) noexcept {
+    memory.store(regs.get_index(), op.x, regs.get_regs_span());
+    if constexpr (Q::set.increment_index) {
+        regs.add_index(op.x + 1);
+    }
+}
 
-void other_operations(const Opcode &op, Registers &regs, RAM<> &memory, Display &display, i8 &key_pressed) noexcept;
+template <typename Q>
+inline void load_from_ram(const Instruction &op, Registers &regs, RAM<> &memory) noexcept {
+    memory.load(regs.get_index(), op.x, regs.get_regs_span());
+    if constexpr (Q::set.increment_index) {
+        regs.add_index(op.x + 1);
+    }
+}
+
+// FX75 and FX85, V0 to VX
+inline void store_flags(const Instruction &op, const Registers &regs, RplFlags &flags) noexcept {
+    for (u8 reg = 0; reg <= op.x; ++reg) {
+        flags.at(reg) = regs.at(reg);
+    }
+}
+
+inline void load_flags(const Instruction &op, Registers &regs, const RplFlags &flags) noexcept {
+    for (u8 reg = 0; reg <= op.x; ++reg) {
+        regs.at(reg) = flags.at(reg);
+    }
+}
 
 } // namespace commands
 
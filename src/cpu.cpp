@@ -1,141 +1,499 @@
 #include "cpu.h"
 
+#include "aot.h"
 #include "commands.h"
 #include "ram.h"
 
+#include <algorithm>
 #include <limits>
+#include <stdexcept>
 
 namespace {
-// instruction execution frequency
-constexpr u16 instr_per_sec = 500;                    // frequency
-constexpr double sec_per_instr = 1.0 / instr_per_sec; // period
+void invalidate_jit(void *jit, u16 first, u16 last) {
+    static_cast<Jit *>(jit)->invalidate(first, last);
+}
+
+void mark_written(void *written, u16 first, u16 last) {
+    auto &bits = *static_cast<std::bitset<default_memory_size> *>(written);
+    for (std::size_t i = first; i <= last && i < bits.size(); ++i) {
+        bits.set(i);
+    }
+}
 
 } // namespace
 
-Rng::Rng() : m_engine(m_rd()), m_dist(0, std::numeric_limits<u8>::max()) {}
+const std::array<CPU::HandlerTable, quirk_profile_count> CPU::m_handler_tables{
+    CPU::make_handler_table<Quirks<QuirkProfile::Chip8>>(),
+    CPU::make_handler_table<Quirks<QuirkProfile::CosmacVip>>(),
+    CPU::make_handler_table<Quirks<QuirkProfile::SuperChip>>(),
+    CPU::make_handler_table<Quirks<QuirkProfile::XoChip>>(),
+};
+
+CPU::CPU(const std::filesystem::path &rom_file, Frontend &frontend, Dispatch dispatch, QuirkProfile quirks) : CPU(read_rom_file(rom_file), frontend, dispatch, quirks) {}
 
-unsigned int Rng::gen() {
-    return m_dist(m_engine);
+CPU::CPU(gsl::span<const u8> rom, Frontend &frontend, Dispatch dispatch, QuirkProfile quirks) : m_dispatch(dispatch), m_quirks(quirks), m_engine(&CPU::run_threaded), m_handlers(&m_handler_tables.at(static_cast<std::size_t>(quirks))), m_program(nullptr), m_memory(rom), m_regs(rom_start), m_flags{}, m_instr_per_sec(instr_per_sec), m_time_passed(0), m_time_dropped(0), m_tick_phase(0), m_frame_phase(0), m_frontend(frontend), m_key_pressed(-1), m_display_wait(false) {
+    if (m_dispatch == Dispatch::Jit) {
+        m_jit = std::make_unique<Jit>(quirks);
+        m_memory.set_write_hook(invalidate_jit, m_jit.get());
+        m_engine = &CPU::run_jit;
+    } else if (m_dispatch == Dispatch::Aot) {
+        // no program to run, interpret everything
+        m_dispatch = Dispatch::Threaded;
+    } else if (m_dispatch == Dispatch::Switch) {
+        m_engine = with_quirks(quirks, []<typename Q>() -> Engine { return &CPU::run_switch<Q>; });
+    }
 }
 
-CPU::CPU(const std::filesystem::path &rom_file) : m_memory(rom_file), m_regs(rom_start), m_time_passed(0), m_key_pressed(-1) {}
+CPU::CPU(gsl::span<const u8> rom, Frontend &frontend, AotProgram program, QuirkProfile quirks) : CPU(rom, frontend, Dispatch::Threaded, quirks) {
+    m_dispatch = Dispatch::Aot;
+    m_engine = &CPU::run_translated;
+    m_program = program;
+    m_memory.set_write_hook(mark_written, &m_written);
+}
 
-void CPU::instr_cycle(const double dt) {
+CycleReport CPU::instr_cycle(const double dt) {
+    CycleReport report;
     m_time_passed += dt;
-    m_regs.update_timers(dt);
 
-    if (m_time_passed >= sec_per_instr) {
-        m_time_passed -= sec_per_instr;
+    // never try to catch up on more than max_catch_up, or a slow host
+    // spends ever longer catching up and falls further behind
+    if (m_time_passed > max_catch_up) {
+        report.dropped = m_time_passed - max_catch_up;
+        m_time_passed = max_catch_up;
+        m_time_dropped += report.dropped;
+    }
+
+    auto max_catch_up_instr = static_cast<unsigned int>(max_catch_up * m_instr_per_sec);
+    auto budget = std::min(static_cast<unsigned int>(m_time_passed * m_instr_per_sec), max_catch_up_instr);
+    if (budget > 0) {
+        m_time_passed -= static_cast<double>(budget) / m_instr_per_sec;
 
-        // execute instructions
-        fetch_decode_execute();
+        // execute instructions, fewer than budget once the machine traps
+        report.executed = run(budget);
 
-        m_display.swap_buffers();
-        m_display.poll_events();
+        m_frontend.present(m_framebuffer);
+        m_frontend.poll_events();
     }
+    return report;
 }
 
-void CPU::fetch_decode_execute() {
-    auto op = m_memory.fetch(m_regs.get_pc());
+void CPU::save(Snapshot &snapshot) const noexcept {
+    snapshot.magic = snapshot_magic;
+    snapshot.version = snapshot_version;
+    snapshot.size = sizeof(Snapshot);
+    snapshot.quirks = m_quirks;
+
+    auto memory = m_memory.data();
+    std::copy(memory.begin(), memory.end(), snapshot.memory.begin());
+    snapshot.regs = m_regs;
+    snapshot.flags = m_flags;
+    snapshot.stack = m_stack;
+    snapshot.framebuffer = m_framebuffer;
+    snapshot.rng = m_rng;
+    snapshot.trap = m_trap;
+    snapshot.key_pressed = m_key_pressed;
+    snapshot.display_wait = m_display_wait;
+
+    snapshot.instr_per_sec = m_instr_per_sec;
+    snapshot.tick_phase = m_tick_phase;
+    snapshot.frame_phase = m_frame_phase;
+    snapshot.time_passed = m_time_passed;
+}
+
+bool CPU::is_valid(const Snapshot &snapshot) noexcept {
+    constexpr i8 last_key = 0xf;
+    return is_compatible(snapshot) && static_cast<std::size_t>(snapshot.quirks) < quirk_profile_count && snapshot.stack.sp() <= CallStack<>::depth && snapshot.key_pressed >= -1 && snapshot.key_pressed <= last_key && snapshot.trap.kind <= Trap::Exit && snapshot.instr_per_sec > 0 && snapshot.tick_phase < snapshot.instr_per_sec && snapshot.frame_phase < timer_hz && snapshot.regs.get_pc() + 1 < default_memory_size;
+}
+
+void CPU::load(const Snapshot &snapshot) {
+    if (!is_compatible(snapshot)) {
+        throw std::runtime_error("snapshot was saved by another version");
+    }
+    if (!is_valid(snapshot)) {
+        throw std::runtime_error("snapshot holds an invalid state");
+    }
+    if (snapshot.quirks != m_quirks) {
+        throw std::runtime_error("snapshot was saved with other quirks");
+    }
+
+    // memory goes through RAM so decoded and compiled code is invalidated
+    m_memory.restore(snapshot.memory);
+    m_regs = snapshot.regs;
+    m_flags = snapshot.flags;
+    m_stack = snapshot.stack;
+    m_framebuffer = snapshot.framebuffer;
+    m_rng = snapshot.rng;
+    m_trap = snapshot.trap;
+    m_key_pressed = snapshot.key_pressed;
+    m_display_wait = snapshot.display_wait;
+
+    m_instr_per_sec = snapshot.instr_per_sec;
+    m_tick_phase = snapshot.tick_phase;
+    m_frame_phase = snapshot.frame_phase;
+    m_time_passed = snapshot.time_passed;
+}
+
+unsigned int CPU::run_frame() {
+    auto count = step_frame();
+    m_frontend.present(m_framebuffer);
+    m_frontend.poll_events();
+    return count;
+}
+
+unsigned int CPU::step_frame() {
+    // frames alternate between the two nearest whole instruction counts
+    m_frame_phase += m_instr_per_sec;
+    unsigned int count = m_frame_phase / timer_hz;
+    m_frame_phase %= timer_hz;
+
+    return run(count);
+}
+
+void CPU::set_instr_per_frame(unsigned int instr_per_frame) noexcept {
+    Expects(instr_per_frame > 0);
+    m_instr_per_sec = instr_per_frame * timer_hz;
+    m_tick_phase = 0;
+    m_frame_phase = 0;
+}
+
+unsigned int CPU::run(unsigned int count) {
+    bool was_trapped = is_trapped();
+    unsigned int executed = 0;
+
+    // run up to each tick, integer steps keep the timers exact over any split
+    while (count > 0 && !is_trapped()) {
+        unsigned int until_tick = (m_instr_per_sec - m_tick_phase + timer_hz - 1) / timer_hz;
+        unsigned int segment = std::min(count, until_tick);
+        if (!m_display_wait) {
+            executed += (this->*m_engine)(segment);
+        }
+        count -= segment;
+
+        m_tick_phase += segment * timer_hz;
+        if (m_tick_phase >= m_instr_per_sec) {
+            m_tick_phase -= m_instr_per_sec;
+            m_regs.tick_timers();
+            m_display_wait = false;
+        }
+    }
+
+    // the instruction that trapped was undone
+    return executed - (is_trapped() && !was_trapped ? 1 : 0);
+}
+
+template <typename Q>
+unsigned int CPU::run_switch(unsigned int count) {
+    unsigned int executed = 0;
+    for (; executed < count && is_running(); ++executed) {
+        fetch_decode_execute<Q>();
+    }
+    return executed;
+}
+
+unsigned int CPU::run_threaded(unsigned int count) {
+    unsigned int executed = 0;
+    for (; executed < count && is_running(); ++executed) {
+        fetch_dispatch_threaded();
+    }
+    return executed;
+}
+
+void CPU::raise(Trap trap) noexcept {
+    if (trap != Trap::None) {
+        m_regs.decr_pc();
+        m_trap = CpuTrap{ trap, m_regs.get_pc() };
+    }
+}
+
+void CPU::fetch_dispatch_threaded() {
+    const auto op = m_memory.fetch_decoded(m_regs.get_pc());
     m_regs.incr_pc();
 
-    // detect type of operation
-    switch (op.get_operation_type()) {
+    (*m_handlers)[static_cast<std::size_t>(op.kind)](*this, op);
+}
 
-        case (Operation::ClearReturn): {
-            commands::clear_or_return(op, m_display, m_stack, m_regs);
-            break;
+unsigned int CPU::run_jit(unsigned int count) {
+    unsigned int executed = 0;
+    while (executed < count && is_running()) {
+        const auto *block = m_jit->block(m_regs.get_pc(), m_memory);
+        // blocks stop at the budget themselves, so a tick can fall inside one
+        if (block != nullptr) {
+            auto budget = count - executed;
+            auto index = m_regs.get_index();
+            m_regs.set_pc(block->code(m_regs.get_regs_span().data(), &index, budget));
+            m_regs.set_index(index);
+            m_jit->record_run(block->executed(budget));
+            executed += block->executed(budget);
+        } else {
+            fetch_dispatch_threaded();
+            ++executed;
+        }
+    }
+    return executed;
+}
+
+unsigned int CPU::run_translated(unsigned int count) {
+    AotMachine machine{ m_regs, m_memory, m_framebuffer, m_frontend, m_stack, m_rng, m_key_pressed, m_flags, m_written };
+    unsigned int executed = 0;
+    while (executed < count && is_running()) {
+        executed += m_program(machine, count - executed);
+        if (executed < count) {
+            // the program stopped at something it does not translate
+            fetch_dispatch_threaded();
+            ++executed;
         }
+    }
+    return executed;
+}
+
+template <typename Q>
+CPU::HandlerTable CPU::make_handler_table() noexcept {
+    HandlerTable table{};
+    auto set = [&table](Instr kind, Handler handler) {
+        table.at(static_cast<std::size_t>(kind)) = handler;
+    };
 
-        case (Operation::Jump): {
-            // std::cout << "jumping\n";
+    auto ignore = [](CPU &, const Instruction &) {};
+    set(Instr::NotDecoded, ignore);
+    set(Instr::Unknown, ignore);
+    set(Instr::MachineRoutine, [](CPU &, const Instruction &) { std::cout << "skip instruction\n"; });
+    set(Instr::Clear, [](CPU &cpu, const Instruction &) { commands::clear(cpu.m_framebuffer); });
+    set(Instr::Return, [](CPU &cpu, const Instruction &) { cpu.raise(commands::ret(cpu.m_stack, cpu.m_regs)); });
+    set(Instr::ScrollDown, [](CPU &cpu, const Instruction &op) { commands::scroll_down(op, cpu.m_framebuffer); });
+    set(Instr::ScrollRight, [](CPU &cpu, const Instruction &) { commands::scroll_right(cpu.m_framebuffer); });
+    set(Instr::ScrollLeft, [](CPU &cpu, const Instruction &) { commands::scroll_left(cpu.m_framebuffer); });
+    set(Instr::Exit, [](CPU &cpu, const Instruction &) { cpu.raise(Trap::Exit); });
+    set(Instr::LowRes, [](CPU &cpu, const Instruction &) { commands::set_high_res(cpu.m_framebuffer, false); });
+    set(Instr::HighRes, [](CPU &cpu, const Instruction &) { commands::set_high_res(cpu.m_framebuffer, true); });
+    set(Instr::Jump, [](CPU &cpu, const Instruction &op) { commands::jump(op, cpu.m_regs); });
+    set(Instr::Call, [](CPU &cpu, const Instruction &op) { cpu.raise(commands::call(op, cpu.m_stack, cpu.m_regs)); });
+    set(Instr::IfRegNotEqualValue, [](CPU &cpu, const Instruction &op) { commands::if_reg_not_eq_value(op, cpu.m_regs); });
+    set(Instr::IfRegEqualValue, [](CPU &cpu, const Instruction &op) { commands::if_reg_eq_value(op, cpu.m_regs); });
+    set(Instr::IfRegNotEqualReg, [](CPU &cpu, const Instruction &op) { commands::if_reg_not_eq_reg(op, cpu.m_regs); });
+    set(Instr::SetRegValue, [](CPU &cpu, const Instruction &op) { commands::set_reg_value(op, cpu.m_regs); });
+    set(Instr::AddToReg, [](CPU &cpu, const Instruction &op) { commands::add_to_reg(op, cpu.m_regs); });
+    set(Instr::Set, [](CPU &cpu, const Instruction &op) { commands::set(op, cpu.m_regs); });
+    set(Instr::BitwiseOr, [](CPU &cpu, const Instruction &op) { commands::bitwise_or<Q>(op, cpu.m_regs); });
+    set(Instr::BitwiseAnd, [](CPU &cpu, const Instruction &op) { commands::bitwise_and<Q>(op, cpu.m_regs); });
+    set(Instr::BitwiseXor, [](CPU &cpu, const Instruction &op) { commands::bitwise_xor<Q>(op, cpu.m_regs); });
+    set(Instr::Addition, [](CPU &cpu, const Instruction &op) { commands::addition(op, cpu.m_regs); });
+    set(Instr::Subtraction, [](CPU &cpu, const Instruction &op) { commands::subtraction(op, cpu.m_regs); });
+    set(Instr::ShiftRight, [](CPU &cpu, const Instruction &op) { commands::shift_right<Q>(op, cpu.m_regs); });
+    set(Instr::AltSubtraction, [](CPU &cpu, const Instruction &op) { commands::alt_subtraction(op, cpu.m_regs); });
+    set(Instr::ShiftLeft, [](CPU &cpu, const Instruction &op) { commands::shift_left<Q>(op, cpu.m_regs); });
+    set(Instr::IfRegEquality, [](CPU &cpu, const Instruction &op) { commands::if_reg_eq_reg(op, cpu.m_regs); });
+    set(Instr::SetIndex, [](CPU &cpu, const Instruction &op) { commands::set_index(op, cpu.m_regs); });
+    set(Instr::JumpV0Addr, [](CPU &cpu, const Instruction &op) { commands::jump_add_plus_v0<Q>(op, cpu.m_regs); });
+    set(Instr::RandomNumber, [](CPU &cpu, const Instruction &op) { commands::random_number(op, cpu.m_regs, cpu.m_rng); });
+    set(Instr::LoadSprite, [](CPU &cpu, const Instruction &op) {
+        commands::load_sprite<Q>(op, cpu.m_regs, cpu.m_memory, cpu.m_framebuffer);
+        cpu.m_display_wait = Q::set.display_wait;
+    });
+    set(Instr::IfKeyNotPressed, [](CPU &cpu, const Instruction &op) { commands::if_key_not_pressed(op, cpu.m_regs, cpu.m_frontend); });
+    set(Instr::IfKeyPressed, [](CPU &cpu, const Instruction &op) { commands::if_key_pressed(op, cpu.m_regs, cpu.m_frontend); });
+    set(Instr::SetVxDelay, [](CPU &cpu, const Instruction &op) { commands::set_vx_delay(op, cpu.m_regs); });
+    set(Instr::SetVxKey, [](CPU &cpu, const Instruction &op) { commands::set_vx_key(op, cpu.m_regs, cpu.m_frontend, cpu.m_key_pressed); });
+    set(Instr::SetDelay, [](CPU &cpu, const Instruction &op) { commands::set_delay(op, cpu.m_regs); });
+    set(Instr::SetBuzzer, [](CPU &cpu, const Instruction &op) { commands::set_buzzer(op, cpu.m_regs); });
+    set(Instr::AddVxToIndex, [](CPU &cpu, const Instruction &op) { commands::add_vx_to_index(op, cpu.m_regs); });
+    set(Instr::SetIndexToHex, [](CPU &cpu, const Instruction &op) { commands::set_index_to_hex(op, cpu.m_regs, cpu.m_memory); });
+    set(Instr::SetIndexToBigHex, [](CPU &cpu, const Instruction &op) { commands::set_index_to_big_hex(op, cpu.m_regs, cpu.m_memory); });
+    set(Instr::BcdVx, [](CPU &cpu, const Instruction &op) { commands::bcd_vx(op, cpu.m_regs, cpu.m_memory); });
+    set(Instr::StoreToRam, [](CPU &cpu, const Instruction &op) { commands::store_to_ram<Q>(op, cpu.m_regs, cpu.m_memory); });
+    set(Instr::LoadFromRam, [](CPU &cpu, const Instruction &op) { commands::load_from_ram<Q>(op, cpu.m_regs, cpu.m_memory); });
+    set(Instr::StoreFlags, [](CPU &cpu, const Instruction &op) { commands::store_flags(op, cpu.m_regs, cpu.m_flags); });
+    set(Instr::LoadFlags, [](CPU &cpu, const Instruction &op) { commands::load_flags(op, cpu.m_regs, cpu.m_flags); });
+
+    return table;
+}
+
+template <typename Q>
+void CPU::fetch_decode_execute() {
+    // copy, executing the instruction may invalidate the cached entry
+    const auto op = m_memory.fetch_decoded(m_regs.get_pc());
+    m_regs.incr_pc();
+
+    switch (op.kind) {
+        case (Instr::Clear): {
+            commands::clear(m_framebuffer);
+            break;
+        }
+        case (Instr::Return): {
+            raise(commands::ret(m_stack, m_regs));
+            break;
+        }
+        case (Instr::ScrollDown): {
+            commands::scroll_down(op, m_framebuffer);
+            break;
+        }
+        case (Instr::ScrollRight): {
+            commands::scroll_right(m_framebuffer);
+            break;
+        }
+        case (Instr::ScrollLeft): {
+            commands::scroll_left(m_framebuffer);
+            break;
+        }
+        case (Instr::Exit): {
+            raise(Trap::Exit);
+            break;
+        }
+        case (Instr::LowRes): {
+            commands::set_high_res(m_framebuffer, false);
+            break;
+        }
+        case (Instr::HighRes): {
+            commands::set_high_res(m_framebuffer, true);
+            break;
+        }
+        case (Instr::Jump): {
             commands::jump(op, m_regs);
             break;
         }
-
-        case (Operation::Call): {
-            // std::cout << "calling subroutine\n";
-            commands::call(op, m_stack, m_regs);
+        case (Instr::Call): {
+            raise(commands::call(op, m_stack, m_regs));
             break;
         }
-
-        case (Operation::IfRegNotEqualValue): {
-            // std::cout << "skip if vx == NN\n";
+        case (Instr::IfRegNotEqualValue): {
             commands::if_reg_not_eq_value(op, m_regs);
             break;
         }
-
-        case (Operation::IfRegEqualValue): {
-            // std::cout << "skip if vx != NN\n";
+        case (Instr::IfRegEqualValue): {
             commands::if_reg_eq_value(op, m_regs);
             break;
         }
-
-        case (Operation::IfRegNotEqualReg): {
-            // std::cout << "skip if vx == vy\n";
+        case (Instr::IfRegNotEqualReg): {
             commands::if_reg_not_eq_reg(op, m_regs);
             break;
         }
-
-        case (Operation::SetRegValue): {
-            // std::cout << "set register\n";
+        case (Instr::SetRegValue): {
             commands::set_reg_value(op, m_regs);
             break;
         }
-
-        case (Operation::AddToReg): {
-            // std::cout << "add NN to vx\n";
+        case (Instr::AddToReg): {
             commands::add_to_reg(op, m_regs);
             break;
         }
-
-        case (Operation::RegOperations): {
-            commands::reg_operations(op, m_regs);
+        case (Instr::Set): {
+            commands::set(op, m_regs);
             break;
         }
-
-        case (Operation::IfRegEquality): {
-            // std::cout << "skip if vx != vy\n";
+        case (Instr::BitwiseOr): {
+            commands::bitwise_or<Q>(op, m_regs);
+            break;
+        }
+        case (Instr::BitwiseAnd): {
+            commands::bitwise_and<Q>(op, m_regs);
+            break;
+        }
+        case (Instr::BitwiseXor): {
+            commands::bitwise_xor<Q>(op, m_regs);
+            break;
+        }
+        case (Instr::Addition): {
+            commands::addition(op, m_regs);
+            break;
+        }
+        case (Instr::Subtraction): {
+            commands::subtraction(op, m_regs);
+            break;
+        }
+        case (Instr::ShiftRight): {
+            commands::shift_right<Q>(op, m_regs);
+            break;
+        }
+        case (Instr::AltSubtraction): {
+            commands::alt_subtraction(op, m_regs);
+            break;
+        }
+        case (Instr::ShiftLeft): {
+            commands::shift_left<Q>(op, m_regs);
+            break;
+        }
+        case (Instr::IfRegEquality): {
             commands::if_reg_eq_reg(op, m_regs);
             break;
         }
-
-        case (Operation::SetIndex): {
-            // std::cout << "set index\n";
+        case (Instr::SetIndex): {
             commands::set_index(op, m_regs);
             break;
         }
-
-        case (Operation::JumpV0Addr): {
-            // std::cout << "jump with offset\n";
-            commands::jump_add_plus_v0(op, m_regs);
+        case (Instr::JumpV0Addr): {
+            commands::jump_add_plus_v0<Q>(op, m_regs);
             break;
         }
-
-        case (Operation::RandomNumber): {
-            // std::cout << "generate random number AND it with NN and set it to vx\n"
+        case (Instr::RandomNumber): {
             commands::random_number(op, m_regs, m_rng);
             break;
         }
-
-        case (Operation::LoadSprite): {
-            // std::cout << "drawing sprite\n";
-            commands::load_sprite(op, m_regs, m_memory, m_display);
+        case (Instr::LoadSprite): {
+            commands::load_sprite<Q>(op, m_regs, m_memory, m_framebuffer);
+            m_display_wait = Q::set.display_wait;
             break;
         }
-
-        case (Operation::KeyPress): {
-            commands::key_press_operations(op, m_regs, m_display);
+        case (Instr::IfKeyNotPressed): {
+            commands::if_key_not_pressed(op, m_regs, m_frontend);
             break;
         }
-
-        case (Operation::Other): {
-            commands::other_operations(op, m_regs, m_memory, m_display, m_key_pressed);
+        case (Instr::IfKeyPressed): {
+            commands::if_key_pressed(op, m_regs, m_frontend);
             break;
         }
-
-        default: {
-            std::cout << "unknown instruction\n";
+        case (Instr::SetVxDelay): {
+            commands::set_vx_delay(op, m_regs);
+            break;
+        }
+        case (Instr::SetVxKey): {
+            commands::set_vx_key(op, m_regs, m_frontend, m_key_pressed);
+            break;
+        }
+        case (Instr::SetDelay): {
+            commands::set_delay(op, m_regs);
+            break;
+        }
+        case (Instr::SetBuzzer): {
+            commands::set_buzzer(op, m_regs);
+            break;
+        }
+        case (Instr::AddVxToIndex): {
+            commands::add_vx_to_index(op, m_regs);
+            break;
+        }
+        case (Instr::SetIndexToHex): {
+            commands::set_index_to_hex(op, m_regs, m_memory);
+            break;
+        }
+        case (Instr::SetIndexToBigHex): {
+            commands::set_index_to_big_hex(op, m_regs, m_memory);
+            break;
+        }
+        case (Instr::BcdVx): {
+            commands::bcd_vx(op, m_regs, m_memory);
+            break;
+        }
+        case (Instr::StoreToRam): {
+            commands::store_to_ram<Q>(op, m_regs, m_memory);
+            break;
+        }
+        case (Instr::LoadFromRam): {
+            commands::load_from_ram<Q>(op, m_regs, m_memory);
+            break;
+        }
+        case (Instr::StoreFlags): {
+            commands::store_flags(op, m_regs, m_flags);
+            break;
+        }
+        case (Instr::LoadFlags): {
+            commands::load_flags(op, m_regs, m_flags);
+            break;
+        }
+        case (Instr::MachineRoutine): {
+            std::cout << "skip instruction\n";
+            break;
+        }
+        case (Instr::Unknown):
+        case (Instr::NotDecoded): {
+            break;
         }
     }
 }
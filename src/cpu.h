@@ -1,52 +1,219 @@
 #ifndef C8_CPU_H
 #define C8_CPU_H
 
+#include "call_stack.h"
 #include "common.h"
-#include "display.h"
+#include "decoder.h"
+#include "framebuffer.h"
+#include "frontend.h"
+#include "jit.h"
+#include "quirks.h"
 #include "ram.h"
 #include "registers.h"
+#include "rng.h"
+#include "snapshot.h"
+
+#include <gsl/gsl>
 
 #include <array>
+#include <bitset>
 #include <filesystem>
-#include <random>
-#include <stack>
+#include <memory>
 
-class Rng {
-  public:
-    Rng();
+// default instruction execution frequency
+constexpr u16 instr_per_sec = 500;                    // frequency
+constexpr double sec_per_instr = 1.0 / instr_per_sec; // period
 
-    unsigned int gen();
+// delay and sound timers tick timer_hz times per emulated second
+constexpr u16 timer_hz = 60;
 
-  private:
-    std::random_device m_rd;
-    std::mt19937 m_engine;
-    std::uniform_int_distribution<unsigned int> m_dist;
-}; // for random number generation
+// most emulated time one instr_cycle catches up on, anything older is dropped
+constexpr double max_catch_up = 0.25;
+
+// what one instr_cycle did with the time it was given
+struct CycleReport {
+    unsigned int executed = 0; // instructions run
+    double dropped = 0;        // seconds of emulated time given up on
+};
+
+// how decoded instructions are dispatched to their commands
+enum class Dispatch : u8 {
+    Switch,   // one switch over the instruction kind
+    Threaded, // indirect call through a table indexed by the instruction kind
+    Jit,      // native x86-64 blocks, threaded dispatch for everything else
+    Aot,      // rom translated ahead of time, threaded dispatch for everything else
+};
+
+#ifdef CH_THREADED_DISPATCH
+constexpr Dispatch default_dispatch = Dispatch::Threaded;
+#else
+constexpr Dispatch default_dispatch = Dispatch::Switch;
+#endif
+
+struct AotMachine;
+using AotProgram = unsigned int (*)(AotMachine &machine, unsigned int budget);
 
 class CPU {
   public:
-    CPU(const std::filesystem::path &rom_file);
+    CPU(const std::filesystem::path &rom_file, Frontend &frontend, Dispatch dispatch = default_dispatch, QuirkProfile quirks = QuirkProfile::Chip8);
+    CPU(gsl::span<const u8> rom, Frontend &frontend, Dispatch dispatch = default_dispatch, QuirkProfile quirks = QuirkProfile::Chip8);
+
+    // run rom through a program chip8_translate generated from it for the
+    // same quirks
+    CPU(gsl::span<const u8> rom, Frontend &frontend, AotProgram program, QuirkProfile quirks = QuirkProfile::Chip8);
+
+    // wall clock mode: run every instruction due after dt more seconds, then
+    // present and poll the frontend once; meant to be called once per host frame
+    CycleReport instr_cycle(double dt);
+
+    // virtual clock mode: run the instructions of one 1 / timer_hz frame,
+    // then present and poll the frontend once. Returns how many ran
+    unsigned int run_frame();
 
-    void instr_cycle(double dt);
+    // run_frame without presenting or polling
+    unsigned int step_frame();
+
+    // emulated speed, timers tick once every instr_per_frame instructions
+    void set_instr_per_frame(unsigned int instr_per_frame) noexcept;
+
+    // restart the random number generator from seed, for reproducible runs
+    inline void seed(u32 seed) noexcept {
+        m_rng = Rng(seed);
+    }
+
+    [[nodiscard]] inline unsigned int get_instr_per_sec() const noexcept {
+        return m_instr_per_sec;
+    }
+
+    [[nodiscard]] inline QuirkProfile quirks() const noexcept {
+        return m_quirks;
+    }
+
+    // what ran as native code, nothing unless the JIT engine is in use
+    [[nodiscard]] inline Jit::Stats jit_stats() const noexcept {
+        return m_jit ? m_jit->stats() : Jit::Stats{};
+    }
+
+    // execute count instructions without presenting or polling the frontend,
+    // ticking the timers every get_instr_per_sec() / timer_hz instructions.
+    // Stops early at a trap, nothing runs while one is pending. With the
+    // display_wait quirk the time left until the next tick after a draw
+    // passes without running anything. Returns how many ran, the
+    // instruction that trapped not included
+    unsigned int run(unsigned int count);
+
+    inline unsigned int step() {
+        return run(1);
+    }
+
+    // total emulated time dropped because the host fell too far behind
+    [[nodiscard]] inline double dropped_time() const noexcept {
+        return m_time_dropped;
+    }
 
     [[nodiscard]] bool should_terminate() const {
-        return m_display.should_close();
+        return m_frontend.should_close();
+    }
+
+    [[nodiscard]] inline const Framebuffer &framebuffer() const noexcept {
+        return m_framebuffer;
+    }
+
+    [[nodiscard]] inline const Registers &registers() const noexcept {
+        return m_regs;
+    }
+
+    [[nodiscard]] inline const RAM<> &memory() const noexcept {
+        return m_memory;
+    }
+
+    [[nodiscard]] inline const RplFlags &flags() const noexcept {
+        return m_flags;
+    }
+
+    // copy the whole machine into snapshot, the frontend is not part of it
+    void save(Snapshot &snapshot) const noexcept;
+    // continue from snapshot, throws if it was saved by another version,
+    // under other quirks or is not valid
+    void load(const Snapshot &snapshot);
+
+    // whether snapshot was saved by this version and holds a state the
+    // machine can run from, checked before any of it is applied. Any index
+    // is fine, FX1E and FX55 take it past the end of memory on their own
+    [[nodiscard]] static bool is_valid(const Snapshot &snapshot) noexcept;
+
+    [[nodiscard]] inline const CallStack<> &stack() const noexcept {
+        return m_stack;
+    }
+
+    [[nodiscard]] inline const CpuTrap &trap() const noexcept {
+        return m_trap;
+    }
+
+    [[nodiscard]] inline bool is_trapped() const noexcept {
+        return m_trap.kind != Trap::None;
     }
 
   private:
+    using Handler = void (*)(CPU &, const Instruction &);
+    using HandlerTable = std::array<Handler, instr_count>;
+    using Engine = unsigned int (CPU::*)(unsigned int count);
+
+    template <typename Q>
+    static HandlerTable make_handler_table() noexcept;
+
+    // whether the engine may run another instruction
+    [[nodiscard]] inline bool is_running() const noexcept {
+        return !is_trapped() && !m_display_wait;
+    }
+
+    template <typename Q>
+    unsigned int run_switch(unsigned int count);
+    template <typename Q>
     void fetch_decode_execute();
+    unsigned int run_threaded(unsigned int count);
+    void fetch_dispatch_threaded();
+    unsigned int run_jit(unsigned int count);
+    unsigned int run_translated(unsigned int count);
+
+    // stop at the instruction that raised trap, if any
+    void raise(Trap trap) noexcept;
+
+    // one table per quirk profile, indexed by QuirkProfile
+    static const std::array<HandlerTable, quirk_profile_count> m_handler_tables;
+    Dispatch m_dispatch;
+    QuirkProfile m_quirks;
+    // picked once for the dispatch and quirks, never branches on either
+    Engine m_engine;
+    const HandlerTable *m_handlers;
+    std::unique_ptr<Jit> m_jit;
+    AotProgram m_program;
+    std::bitset<default_memory_size> m_written;
 
     RAM<> m_memory;
-    std::stack<u16> m_stack;
+    CallStack<> m_stack;
+    CpuTrap m_trap;
 
     Registers m_regs;
+    RplFlags m_flags;
+    unsigned int m_instr_per_sec;
     double m_time_passed;
+    double m_time_dropped;
+
+    // timer_hz per executed instruction, a tick is due at every m_instr_per_sec
+    unsigned int m_tick_phase;
+    // m_instr_per_sec per frame, a frame runs one instruction per timer_hz
+    unsigned int m_frame_phase;
 
-    Display m_display;
+    Framebuffer m_framebuffer;
+    Frontend &m_frontend;
     Rng m_rng;
 
     // key currently pressed or -1 if not pressed
     i8 m_key_pressed;
+
+    // a draw is waiting for the next timer tick
+    bool m_display_wait;
 };
 
 #endif
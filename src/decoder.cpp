@@ -0,0 +1,145 @@
+#include "decoder.h"
+
+namespace {
+Instr decode_clear_return(const Opcode &op) noexcept {
+    // NOLINTNEXTLINE(*magic-numbers*): 00CN without its nibble
+    if (static_cast<ClearReturn>(op.get_12bits() & 0xff0) == ClearReturn::ScrollDown) {
+        return Instr::ScrollDown;
+    }
+    switch (static_cast<ClearReturn>(op.get_12bits())) {
+        case (ClearReturn::Clear):
+            return Instr::Clear;
+        case (ClearReturn::Return):
+            return Instr::Return;
+        case (ClearReturn::ScrollRight):
+            return Instr::ScrollRight;
+        case (ClearReturn::ScrollLeft):
+            return Instr::ScrollLeft;
+        case (ClearReturn::Exit):
+            return Instr::Exit;
+        case (ClearReturn::LowRes):
+            return Instr::LowRes;
+        case (ClearReturn::HighRes):
+            return Instr::HighRes;
+        default:
+            return Instr::MachineRoutine;
+    }
+}
+
+Instr decode_reg_operation(const Opcode &op) noexcept {
+    switch (static_cast<RegOperation>(op.get_nibble(0))) {
+        case (RegOperation::Set):
+            return Instr::Set;
+        case (RegOperation::BitwiseOr):
+            return Instr::BitwiseOr;
+        case (RegOperation::BitwiseAnd):
+            return Instr::BitwiseAnd;
+        case (RegOperation::BitwiseXor):
+            return Instr::BitwiseXor;
+        case (RegOperation::Addition):
+            return Instr::Addition;
+        case (RegOperation::Subtraction):
+            return Instr::Subtraction;
+        case (RegOperation::ShiftRight):
+            return Instr::ShiftRight;
+        case (RegOperation::AltSubtraction):
+            return Instr::AltSubtraction;
+        case (RegOperation::ShiftLeft):
+            return Instr::ShiftLeft;
+        default:
+            return Instr::Unknown;
+    }
+}
+
+Instr decode_key_press(const Opcode &op) noexcept {
+    switch (static_cast<KeyPressOp>(op.get_byte(0))) {
+        case (KeyPressOp::IfKeyNotPressed):
+            return Instr::IfKeyNotPressed;
+        case (KeyPressOp::IfKeyPressed):
+            return Instr::IfKeyPressed;
+        default:
+            return Instr::Unknown;
+    }
+}
+
+Instr decode_other(const Opcode &op) noexcept {
+    switch (static_cast<OtherOp>(op.get_byte(0))) {
+        case (OtherOp::SetVxDelay):
+            return Instr::SetVxDelay;
+        case (OtherOp::SetVxKey):
+            return Instr::SetVxKey;
+        case (OtherOp::SetDelay):
+            return Instr::SetDelay;
+        case (OtherOp::SetBuzzer):
+            return Instr::SetBuzzer;
+        case (OtherOp::AddVxToIndex):
+            return Instr::AddVxToIndex;
+        case (OtherOp::SetIndexToHex):
+            return Instr::SetIndexToHex;
+        case (OtherOp::SetIndexToBigHex):
+            return Instr::SetIndexToBigHex;
+        case (OtherOp::BcdVx):
+            return Instr::BcdVx;
+        case (OtherOp::StoreToRam):
+            return Instr::StoreToRam;
+        case (OtherOp::LoadFromRam):
+            return Instr::LoadFromRam;
+        case (OtherOp::StoreFlags):
+            return Instr::StoreFlags;
+        case (OtherOp::LoadFlags):
+            return Instr::LoadFlags;
+        default:
+            return Instr::Unknown;
+    }
+}
+
+Instr decode_kind(const Opcode &op) noexcept {
+    switch (op.get_operation_type()) {
+        case (Operation::ClearReturn):
+            return decode_clear_return(op);
+        case (Operation::Jump):
+            return Instr::Jump;
+        case (Operation::Call):
+            return Instr::Call;
+        case (Operation::IfRegNotEqualValue):
+            return Instr::IfRegNotEqualValue;
+        case (Operation::IfRegEqualValue):
+            return Instr::IfRegEqualValue;
+        case (Operation::IfRegNotEqualReg):
+            return Instr::IfRegNotEqualReg;
+        case (Operation::SetRegValue):
+            return Instr::SetRegValue;
+        case (Operation::AddToReg):
+            return Instr::AddToReg;
+        case (Operation::RegOperations):
+            return decode_reg_operation(op);
+        case (Operation::IfRegEquality):
+            return Instr::IfRegEquality;
+        case (Operation::SetIndex):
+            return Instr::SetIndex;
+        case (Operation::JumpV0Addr):
+            return Instr::JumpV0Addr;
+        case (Operation::RandomNumber):
+            return Instr::RandomNumber;
+        case (Operation::LoadSprite):
+            return Instr::LoadSprite;
+        case (Operation::KeyPress):
+            return decode_key_press(op);
+        case (Operation::Other):
+            return decode_other(op);
+        default:
+            return Instr::Unknown;
+    }
+}
+} // namespace
+
+Instruction decode(Opcode op) noexcept {
+    return Instruction{
+        .kind = decode_kind(op),
+        .x = op.get_nibble(2),
+        .y = op.get_nibble(1),
+        .n = op.get_nibble(0),
+        .nn = op.get_byte(0),
+        .nnn = op.get_12bits(),
+    };
+}
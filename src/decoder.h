@@ -0,0 +1,75 @@
+#ifndef C8_DECODER_H
+#define C8_DECODER_H
+
+#include "common.h"
+#include "opcode.h"
+
+#include <cstddef>
+
+// every instruction the interpreter knows, with the sub-operations of
+// the 0, 8, E and F groups flattened out. The SUPER-CHIP ones are decoded
+// for every rom, older roms do not use their opcodes
+enum class Instr : u8 {
+    NotDecoded,
+    Unknown,
+    MachineRoutine, // 0NNN, ignored
+    Clear,
+    Return,
+    ScrollDown,  // 00CN
+    ScrollRight, // 00FB
+    ScrollLeft,  // 00FC
+    Exit,        // 00FD
+    LowRes,      // 00FE
+    HighRes,     // 00FF
+    Jump,
+    Call,
+    IfRegNotEqualValue,
+    IfRegEqualValue,
+    IfRegNotEqualReg,
+    SetRegValue,
+    AddToReg,
+    Set,
+    BitwiseOr,
+    BitwiseAnd,
+    BitwiseXor,
+    Addition,
+    Subtraction,
+    ShiftRight,
+    AltSubtraction,
+    ShiftLeft,
+    IfRegEquality,
+    SetIndex,
+    JumpV0Addr,
+    RandomNumber,
+    LoadSprite,
+    IfKeyNotPressed,
+    IfKeyPressed,
+    SetVxDelay,
+    SetVxKey,
+    SetDelay,
+    SetBuzzer,
+    AddVxToIndex,
+    SetIndexToHex,
+    SetIndexToBigHex, // FX30
+    BcdVx,
+    StoreToRam,
+    LoadFromRam,
+    StoreFlags, // FX75
+    LoadFlags,  // FX85
+};
+
+constexpr std::size_t instr_count = static_cast<std::size_t>(Instr::LoadFlags) + 1;
+
+// opcode with its operands already extracted
+struct Instruction {
+    Instr kind = Instr::NotDecoded;
+    u8 x = 0;    // register X (bits 8-11)
+    u8 y = 0;    // register Y (bits 4-7)
+    u8 n = 0;    // lowest 4 bits
+    u8 nn = 0;   // lowest byte
+    u16 nnn = 0; // lowest 12 bits
+};
+
+[[nodiscard]] Instruction decode(Opcode op) noexcept;
+
+#endif
@@ -3,11 +3,7 @@
 #include <GLFW/glfw3.h>
 #include <gsl/gsl_assert>
 
-#include <glm/ext/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include <glm/mat4x4.hpp>
-#include <glm/vec3.hpp>
-
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <format>
@@ -64,6 +60,8 @@ void process_keys(GLFWwindow *window, int key, [[maybe_unused]] int scancode, in
 
     if (key_map.contains(key) && (action == GLFW_PRESS || action == GLFW_RELEASE)) {
         display.toggle_key(static_cast<u8>(key_map.at(key)));
+    } else if (key == GLFW_KEY_BACKSPACE && (action == GLFW_PRESS || action == GLFW_RELEASE)) {
+        display.set_rewinding(action == GLFW_PRESS);
     } else if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, GLFW_TRUE);
     }
@@ -84,7 +82,7 @@ void message_callback([[maybe_unused]] GLenum source, GLenum type,
 }
 } // namespace
 
-Display::Display() : m_window(nullptr, terminate_glfw), m_shader(0), m_pixel_vao(0), m_vbo(0), m_ebo(0), m_model_loc(0), m_color_loc(0), m_display{ { { 0 } } }, m_keys_pressed{ false } {
+Display::Display(bool visible) : m_window(nullptr, terminate_glfw), m_shader(0), m_screen_vao(0), m_vbo(0), m_ebo(0), m_texture(0), m_uploaded{ { { 0 } } }, m_shown{}, m_keys_pressed{ false }, m_rewinding(false) {
     if (!glfwInit()) {
         throw std::runtime_error("There was a problem with glfw");
     }
@@ -93,7 +91,8 @@ Display::Display() : m_window(nullptr, terminate_glfw), m_shader(0), m_pixel_vao
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, gl_version_minor);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-    glfwWindowHint(GLFW_DOUBLEBUFFER, GL_FALSE);
+    glfwWindowHint(GLFW_DOUBLEBUFFER, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
     m_window = GLFWwindow_smart(glfwCreateWindow(window_width, window_height, "CHIP8 Emulator", nullptr, nullptr), terminate_glfw);
     if (!m_window) {
@@ -102,6 +101,8 @@ Display::Display() : m_window(nullptr, terminate_glfw), m_shader(0), m_pixel_vao
     }
 
     glfwMakeContextCurrent(m_window.get());
+    // swap once per refresh, this is what paces the run loop
+    glfwSwapInterval(1);
     int version = gladLoadGL(glfwGetProcAddress);
     std::cout << std::format("OpenGL Version: {}.{}\n", GLAD_VERSION_MAJOR(version), GLAD_VERSION_MINOR(version));
 
@@ -114,19 +115,20 @@ Display::Display() : m_window(nullptr, terminate_glfw), m_shader(0), m_pixel_vao
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
     load_shaders();
-    create_pixel_vao();
+    create_screen_vao();
+    create_screen_texture();
 
     glUseProgram(m_shader);
-    m_model_loc = glGetUniformLocation(m_shader, "model");
-    m_color_loc = glGetUniformLocation(m_shader, "color");
+    glUniform1i(glGetUniformLocation(m_shader, "screen"), 0);
 
-    glBindVertexArray(m_pixel_vao);
+    glBindVertexArray(m_screen_vao);
 }
 
 Display::~Display() {
     glDeleteBuffers(1, &m_vbo);
     glDeleteBuffers(1, &m_ebo);
-    glDeleteBuffers(1, &m_pixel_vao);
+    glDeleteVertexArrays(1, &m_screen_vao);
+    glDeleteTextures(1, &m_texture);
     glDeleteProgram(m_shader);
 }
 
@@ -190,7 +192,7 @@ void Display::load_shaders() {
     glDeleteShader(fragment_shader);
 }
 
-void Display::create_pixel_vao() noexcept {
+void Display::create_screen_vao() noexcept {
     const auto cube_vertices = std::array<float, 12>{
         1.0f, -1.0f, 0.0f,  // bottom right
         1.0f, 1.0f, 0.0f,   // top right
@@ -203,16 +205,16 @@ void Display::create_pixel_vao() noexcept {
         2, 1, 3
     };
 
-    glGenVertexArrays(1, &m_pixel_vao);
-    glBindVertexArray(m_pixel_vao);
+    glGenVertexArrays(1, &m_screen_vao);
+    glBindVertexArray(m_screen_vao);
 
     glGenBuffers(1, &m_vbo);
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, cube_vertices.size() * sizeof(cube_vertices.data()), cube_vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, cube_vertices.size() * sizeof(float), cube_vertices.data(), GL_STATIC_DRAW);
 
     glGenBuffers(1, &m_ebo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cube_indices.size() * sizeof(cube_indices.data()), cube_indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cube_indices.size() * sizeof(unsigned int), cube_indices.data(), GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
     glEnableVertexAttribArray(0);
@@ -222,57 +224,61 @@ void Display::create_pixel_vao() noexcept {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-void Display::clear_screen() noexcept {
-    Expects(m_window);
-    for (auto &row : m_display) {
-        row.fill(0);
-    }
-    glClear(GL_COLOR_BUFFER_BIT);
+void Display::create_screen_texture() noexcept {
+    glActiveTexture(GL_TEXTURE0);
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, schip_width, schip_height);
+
+    // every chip8 pixel covers a block of screen pixels, no filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, schip_width, schip_height, GL_RED, GL_UNSIGNED_BYTE, m_uploaded.data());
 }
 
-bool Display::draw_sprite(std::vector<u8> &&sprite, u8 x, u8 y) noexcept {
-    constexpr u8 byte_in_bits = 8;
-    x %= chip8_width;
-    y %= chip8_height;
-
-    u8 n = sprite.size();
-    u8 current_sprite = 0;
-    bool has_flipped = false;
-    for (u8 i = 0; i < n && y + i < chip8_height; ++i) {
-        current_sprite = sprite.at(i);
-        for (u8 j = 0; j < byte_in_bits && x + j < chip8_width; ++j) {
-            u8 set = current_sprite >> (byte_in_bits - 1 - j) & 1;
-            if (set) {
-                if (m_display.at(y + i).at(x + j) == 1) {
-                    draw_pixel(x + j, y + i, false);
-                    m_display.at(y + i).at(x + j) = 0;
-                    has_flipped = true;
-                } else {
-                    draw_pixel(x + j, y + i, true);
-                    m_display.at(y + i).at(x + j) = 1;
+void Display::present(const Framebuffer &framebuffer) noexcept {
+    Expects(m_window);
+
+    // the texture has the high resolution, a low resolution pixel is
+    // unpacked into scale x scale texels. A change of resolution redraws all
+    const int scale = schip_width / framebuffer.width();
+    const bool resized = framebuffer.is_high_res() != m_shown.is_high_res();
+
+    // upload each run of consecutive changed rows with one call
+    int first_dirty = -1;
+    for (int y = 0; y <= framebuffer.height(); ++y) {
+        bool is_dirty = y < framebuffer.height() && (resized || !std::ranges::equal(framebuffer.row(y), m_shown.row(y)));
+        if (is_dirty) {
+            for (int texel_y = y * scale; texel_y < (y + 1) * scale; ++texel_y) {
+                auto &row = m_uploaded.at(texel_y);
+                for (int texel_x = 0; texel_x < schip_width; ++texel_x) {
+                    row.at(texel_x) = framebuffer.is_set(static_cast<u8>(texel_x / scale), static_cast<u8>(y)) ? m_lit : 0;
                 }
             }
         }
-    }
-
-    return has_flipped;
-}
 
-// -1 + w * 0.5 + x * w = -1 + w(x + 0.5)
-void Display::draw_pixel(const u16 x, const u16 y, bool is_colored) const noexcept {
-    auto pos_x = -1.0f + pixel_width * (static_cast<float>(x) * 2 + 1);
-    auto pos_y = 1.0f - pixel_height * (static_cast<float>(y) * 2 + 1);
-    auto model = glm::translate(glm::mat4(1.0f), glm::vec3(pos_x, pos_y, 0.0f));
-    model = glm::scale(model, glm::vec3(pixel_width, pixel_height, 0.0f));
-    glUniformMatrix4fv(m_model_loc, 1, GL_FALSE, glm::value_ptr(model));
-
-    if (!is_colored) {
-        glUniform3fv(m_color_loc, 1, glm::value_ptr(m_black_color));
-    } else {
-        glUniform3fv(m_color_loc, 1, glm::value_ptr(m_white_color));
+        if (is_dirty && first_dirty == -1) {
+            first_dirty = y;
+        } else if (!is_dirty && first_dirty != -1) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first_dirty * scale, schip_width, (y - first_dirty) * scale, GL_RED, GL_UNSIGNED_BYTE, m_uploaded.at(first_dirty * scale).data());
+            first_dirty = -1;
+        }
     }
+    m_shown = framebuffer;
 
     glDrawElements(GL_TRIANGLES, m_num_of_indices, GL_UNSIGNED_INT, nullptr);
+    glfwSwapBuffers(m_window.get());
+}
+
+std::array<u8, schip_width * schip_height> Display::read_texture() const noexcept {
+    std::array<u8, schip_width * schip_height> pixels{};
+    glGetTextureImage(m_texture, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.size(), pixels.data());
+    return pixels;
 }
 
 bool Display::should_close() const noexcept {
@@ -280,13 +286,11 @@ bool Display::should_close() const noexcept {
     return static_cast<bool>(glfwWindowShouldClose(m_window.get()));
 }
 
-void Display::swap_buffers() const noexcept {
-    Expects(m_window);
-    // glfwSwapBuffers(m_window.get());
-    glFlush();
+void Display::set_vsync(bool enabled) noexcept {
+    glfwSwapInterval(enabled ? 1 : 0);
 }
 
-void Display::poll_events() const noexcept {
+void Display::poll_events() noexcept {
     Expects(m_window);
     glfwPollEvents();
 }
@@ -295,6 +299,10 @@ void Display::toggle_key(u8 key) noexcept {
     m_keys_pressed.at(key) = !m_keys_pressed.at(key);
 }
 
+void Display::set_rewinding(bool rewinding) noexcept {
+    m_rewinding = rewinding;
+}
+
 bool Display::is_pressed(u8 key) const noexcept {
     return m_keys_pressed.at(key);
 }
@@ -0,0 +1,235 @@
+#ifndef C8_FRAMEBUFFER_H
+#define C8_FRAMEBUFFER_H
+
+#include "common.h"
+#include "sprite.h"
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+constexpr u8 chip8_width = 64;
+constexpr u8 chip8_height = 32;
+
+// the SUPER-CHIP high resolution
+constexpr u8 schip_width = 128;
+constexpr u8 schip_height = 64;
+
+// monochrome screen contents of the machine, independent of how they are shown.
+// Every row is packed into 64 bit words, the leftmost pixel in the most
+// significant bit, so drawing a sprite row is a shift and an xor
+template <u8 W, u8 H>
+class BasicFramebuffer {
+  public:
+    static constexpr u8 width = W;
+    static constexpr u8 height = H;
+
+    static constexpr u8 bits_per_word = 64;
+    static constexpr std::size_t words_per_row = W / bits_per_word;
+    static_assert(W % bits_per_word == 0, "rows must be whole words");
+
+    using Row = std::array<u64, words_per_row>;
+
+    BasicFramebuffer() : m_rows{} {}
+
+    inline void clear() noexcept {
+        m_rows.fill(Row{});
+    }
+
+    // xor sprite onto the screen and report whether any pixel was turned off.
+    // The start position always wraps, the sprite itself only with Wrap and
+    // is clipped at the right and bottom edges otherwise
+    template <bool Wrap = false>
+    [[nodiscard]] inline bool draw_sprite(const Sprite &sprite, u8 x, u8 y) noexcept {
+        return draw<Wrap, 8>(sprite, x, y);
+    }
+
+    // draw_sprite for the 16x16 sprites of DXY0, two bytes per row
+    template <bool Wrap = false>
+    [[nodiscard]] inline bool draw_large_sprite(const Sprite &sprite, u8 x, u8 y) noexcept {
+        return draw<Wrap, 16>(sprite, x, y);
+    }
+
+    // move everything n rows down, the rows scrolled in are blank
+    void scroll_down(u8 n) noexcept {
+        n = std::min(n, H);
+        std::copy_backward(m_rows.begin(), m_rows.end() - n, m_rows.end());
+        std::fill(m_rows.begin(), m_rows.begin() + n, Row{});
+    }
+
+    // move everything n < 64 columns right, the columns scrolled in are blank
+    void scroll_right(u8 n) noexcept {
+        Expects(n > 0 && n < bits_per_word);
+        for (auto &row : m_rows) {
+            for (std::size_t word = words_per_row; word-- > 0;) {
+                u64 carry = word > 0 ? row[word - 1] << (bits_per_word - n) : 0;
+                row[word] = row[word] >> n | carry;
+            }
+        }
+    }
+
+    // move everything n < 64 columns left, the columns scrolled in are blank
+    void scroll_left(u8 n) noexcept {
+        Expects(n > 0 && n < bits_per_word);
+        for (auto &row : m_rows) {
+            for (std::size_t word = 0; word < words_per_row; ++word) {
+                u64 carry = word + 1 < words_per_row ? row[word + 1] >> (bits_per_word - n) : 0;
+                row[word] = row[word] << n | carry;
+            }
+        }
+    }
+
+    [[nodiscard]] inline bool is_set(u8 x, u8 y) const noexcept {
+        return (m_rows.at(y).at(x / bits_per_word) >> (bits_per_word - 1 - x % bits_per_word) & 1) != 0;
+    }
+
+    [[nodiscard]] inline const Row &row(u8 y) const noexcept {
+        return m_rows.at(y);
+    }
+
+    // all rows back to back, words_per_row words each
+    [[nodiscard]] inline gsl::span<const u64> words() const noexcept {
+        static_assert(sizeof(m_rows) == sizeof(u64) * words_per_row * H, "rows are stored without padding");
+        return { m_rows.front().data(), words_per_row * H };
+    }
+
+  private:
+    // the sprite rows are Bits wide, 8 or 16
+    template <bool Wrap, u8 Bits>
+    [[nodiscard]] bool draw(const Sprite &sprite, u8 x, u8 y) noexcept {
+        constexpr u8 bytes_per_row = Bits / 8;
+        x %= W;
+        y %= H;
+
+        // the sprite row in the top bits of a word, split across the word
+        // x starts in and the next one, or the first one when wrapping
+        std::size_t word = x / bits_per_word;
+        std::size_t next_word = Wrap ? (word + 1) % words_per_row : word + 1;
+        unsigned int shift = x % bits_per_word;
+        bool straddles = shift > bits_per_word - Bits && (Wrap || next_word < words_per_row);
+
+        auto sprite_rows = sprite.size() / bytes_per_row;
+        auto rows = Wrap ? sprite_rows : std::min<std::size_t>(sprite_rows, H - y);
+        u64 collision = 0;
+        for (std::size_t i = 0; i < rows; ++i) {
+            u64 pattern = sprite[i * bytes_per_row];
+            if constexpr (bytes_per_row == 2) {
+                pattern = pattern << 8 | sprite[i * bytes_per_row + 1];
+            }
+            u64 bits = pattern << (bits_per_word - Bits);
+            auto &row = m_rows[Wrap ? (y + i) % H : y + i];
+
+            u64 first = bits >> shift;
+            collision |= row[word] & first;
+            row[word] ^= first;
+
+            if (straddles) {
+                u64 second = bits << (bits_per_word - shift);
+                collision |= row[next_word] & second;
+                row[next_word] ^= second;
+            }
+        }
+
+        return collision != 0;
+    }
+
+    std::array<Row, H> m_rows;
+};
+
+using LowResFramebuffer = BasicFramebuffer<chip8_width, chip8_height>;
+using HighResFramebuffer = BasicFramebuffer<schip_width, schip_height>;
+
+// the machine's screen, 64x32 or in the SUPER-CHIP high resolution 128x64.
+// Each resolution keeps its own plane, so the low resolution stays at one
+// word per row and every kernel is compiled for the size it draws on
+class Framebuffer {
+  public:
+    // SUPER-CHIP scrolls sideways by 4 pixels
+    static constexpr u8 scroll_step = 4;
+
+    [[nodiscard]] inline bool is_high_res() const noexcept {
+        return m_high_res;
+    }
+
+    // switch resolution, which clears the screen
+    inline void set_high_res(bool high_res) noexcept {
+        m_high_res = high_res;
+        clear();
+    }
+
+    [[nodiscard]] inline u8 width() const noexcept {
+        return m_high_res ? schip_width : chip8_width;
+    }
+
+    [[nodiscard]] inline u8 height() const noexcept {
+        return m_high_res ? schip_height : chip8_height;
+    }
+
+    [[nodiscard]] inline std::size_t words_per_row() const noexcept {
+        return m_high_res ? HighResFramebuffer::words_per_row : LowResFramebuffer::words_per_row;
+    }
+
+    inline void clear() noexcept {
+        if (m_high_res) {
+            m_high.clear();
+        } else {
+            m_low.clear();
+        }
+    }
+
+    template <bool Wrap = false>
+    [[nodiscard]] inline bool draw_sprite(const Sprite &sprite, u8 x, u8 y) noexcept {
+        return m_high_res ? m_high.draw_sprite<Wrap>(sprite, x, y) : m_low.draw_sprite<Wrap>(sprite, x, y);
+    }
+
+    template <bool Wrap = false>
+    [[nodiscard]] inline bool draw_large_sprite(const Sprite &sprite, u8 x, u8 y) noexcept {
+        return m_high_res ? m_high.draw_large_sprite<Wrap>(sprite, x, y) : m_low.draw_large_sprite<Wrap>(sprite, x, y);
+    }
+
+    inline void scroll_down(u8 n) noexcept {
+        if (m_high_res) {
+            m_high.scroll_down(n);
+        } else {
+            m_low.scroll_down(n);
+        }
+    }
+
+    inline void scroll_right() noexcept {
+        if (m_high_res) {
+            m_high.scroll_right(scroll_step);
+        } else {
+            m_low.scroll_right(scroll_step);
+        }
+    }
+
+    inline void scroll_left() noexcept {
+        if (m_high_res) {
+            m_high.scroll_left(scroll_step);
+        } else {
+            m_low.scroll_left(scroll_step);
+        }
+    }
+
+    [[nodiscard]] inline bool is_set(u8 x, u8 y) const noexcept {
+        return m_high_res ? m_high.is_set(x, y) : m_low.is_set(x, y);
+    }
+
+    [[nodiscard]] inline gsl::span<const u64> row(u8 y) const noexcept {
+        return m_high_res ? gsl::span<const u64>(m_high.row(y)) : gsl::span<const u64>(m_low.row(y));
+    }
+
+    // all rows of the current resolution back to back, words_per_row() each
+    [[nodiscard]] inline gsl::span<const u64> words() const noexcept {
+        return m_high_res ? m_high.words() : m_low.words();
+    }
+
+  private:
+    LowResFramebuffer m_low;
+    HighResFramebuffer m_high;
+    bool m_high_res = false;
+};
+
+#endif
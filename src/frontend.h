@@ -0,0 +1,37 @@
+#ifndef C8_FRONTEND_H
+#define C8_FRONTEND_H
+
+#include "common.h"
+#include "framebuffer.h"
+
+// video output and key input of the machine. The emulation core only talks
+// to this interface so it can run without a window or a GL context.
+class Frontend {
+  public:
+    Frontend() = default;
+    virtual ~Frontend() = default;
+
+    Frontend(const Frontend &) = delete;
+    Frontend operator=(const Frontend &) = delete;
+
+    Frontend(Frontend &&) = delete;
+    Frontend operator=(Frontend &&) = delete;
+
+    // show the current contents of the framebuffer
+    virtual void present(const Framebuffer &framebuffer) noexcept = 0;
+    virtual void poll_events() noexcept = 0;
+
+    [[nodiscard]] virtual bool is_pressed(u8 key) const noexcept = 0;
+    [[nodiscard]] virtual bool should_close() const noexcept = 0;
+};
+
+// held keys as a mask, bit n set while key n is down
+[[nodiscard]] inline u16 key_mask(const Frontend &frontend) noexcept {
+    u16 mask = 0;
+    for (u8 key = 0; key < 16; ++key) {
+        mask |= frontend.is_pressed(key) ? 1 << key : 0;
+    }
+    return mask;
+}
+
+#endif
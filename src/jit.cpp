@@ -0,0 +1,337 @@
+#include "jit.h"
+
+#include "commands.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define CH_JIT_X86_64
+#include <sys/mman.h>
+#endif
+
+namespace {
+constexpr std::size_t code_buffer_size = std::size_t{ 1 } << 20;
+constexpr u16 max_block_instructions = 64;
+constexpr std::size_t max_instruction_bytes = 32; // budget check included
+constexpr std::size_t max_block_bytes = (max_block_instructions + 1) * max_instruction_bytes;
+
+// x86-64 machine code for a single block. V0-VF are addressed through rdi,
+// the index register through rsi, the budget is in edx and the next pc is
+// returned in eax.
+class Emitter {
+  public:
+    [[nodiscard]] inline const u8 *data() const noexcept {
+        return m_code.data();
+    }
+
+    [[nodiscard]] inline std::size_t size() const noexcept {
+        return m_size;
+    }
+
+    inline void bytes(std::initializer_list<u8> values) noexcept {
+        for (auto value : values) {
+            m_code.at(m_size++) = value;
+        }
+    }
+
+    inline void imm16(u16 value) noexcept {
+        bytes({ static_cast<u8>(value), static_cast<u8>(value >> 8) });
+    }
+
+    inline void imm32(u16 value) noexcept {
+        imm16(value);
+        bytes({ 0x00, 0x00 });
+    }
+
+    // mov al, [rdi + reg]
+    inline void load_al(u8 reg) noexcept {
+        bytes({ 0x8a, 0x47, reg });
+    }
+
+    // mov [rdi + reg], al
+    inline void store_al(u8 reg) noexcept {
+        bytes({ 0x88, 0x47, reg });
+    }
+
+    // setc/setnc cl; mov [rdi + VF], cl
+    inline void flag_from_carry(bool carry_set) noexcept {
+        bytes({ 0x0f, static_cast<u8>(carry_set ? 0x92 : 0x93), 0xc1 });
+        bytes({ 0x88, 0x4f, commands::flag_register });
+    }
+
+    // mov byte [rdi + VF], 0
+    inline void clear_flag() noexcept {
+        bytes({ 0xc6, 0x47, commands::flag_register, 0x00 });
+    }
+
+    // mov eax, pc; ret
+    inline void return_pc(u16 pc) noexcept {
+        bytes({ 0xb8 });
+        imm32(pc);
+        bytes({ 0xc3 });
+    }
+
+    // return pc unless the budget covers more than done instructions:
+    // cmp edx, done; ja over; mov eax, pc; ret
+    inline void return_if_spent(u8 done, u16 pc) noexcept {
+        bytes({ 0x83, 0xfa, done, 0x77, 0x06 });
+        return_pc(pc);
+    }
+
+    // return pc, or pc + 2 unless the jcc no_skip holds for the last compare
+    inline void return_skip(u16 pc, u8 no_skip) noexcept {
+        bytes({ 0xb8 });
+        imm32(pc);
+        bytes({ no_skip, 0x05 }); // jump over the next mov
+        bytes({ 0xb8 });
+        imm32(pc + 2);
+        bytes({ 0xc3 });
+    }
+
+  private:
+    std::array<u8, max_block_bytes> m_code{};
+    std::size_t m_size = 0;
+};
+
+constexpr u8 jne = 0x75;
+constexpr u8 je = 0x74;
+
+// emit a straight-line instruction, false if it is not translated
+bool emit_straight(Emitter &emitter, const Instruction &op, const QuirkSet &quirks) noexcept {
+    switch (op.kind) {
+        case (Instr::SetRegValue): {
+            emitter.bytes({ 0xc6, 0x47, op.x, op.nn }); // mov byte [rdi + x], nn
+            return true;
+        }
+        case (Instr::AddToReg): {
+            emitter.bytes({ 0x80, 0x47, op.x, op.nn }); // add byte [rdi + x], nn
+            return true;
+        }
+        case (Instr::Set): {
+            emitter.load_al(op.y);
+            emitter.store_al(op.x);
+            return true;
+        }
+        case (Instr::BitwiseOr): {
+            emitter.load_al(op.y);
+            emitter.bytes({ 0x08, 0x47, op.x }); // or [rdi + x], al
+            if (quirks.vf_reset) {
+                emitter.clear_flag();
+            }
+            return true;
+        }
+        case (Instr::BitwiseAnd): {
+            emitter.load_al(op.y);
+            emitter.bytes({ 0x20, 0x47, op.x }); // and [rdi + x], al
+            if (quirks.vf_reset) {
+                emitter.clear_flag();
+            }
+            return true;
+        }
+        case (Instr::BitwiseXor): {
+            emitter.load_al(op.y);
+            emitter.bytes({ 0x30, 0x47, op.x }); // xor [rdi + x], al
+            if (quirks.vf_reset) {
+                emitter.clear_flag();
+            }
+            return true;
+        }
+        case (Instr::Addition): {
+            emitter.load_al(op.y);
+            emitter.bytes({ 0x00, 0x47, op.x }); // add [rdi + x], al
+            emitter.flag_from_carry(true);
+            return true;
+        }
+        case (Instr::Subtraction): {
+            emitter.load_al(op.y);
+            emitter.bytes({ 0x28, 0x47, op.x }); // sub [rdi + x], al
+            emitter.flag_from_carry(false);
+            return true;
+        }
+        case (Instr::AltSubtraction): {
+            emitter.load_al(op.y);
+            emitter.bytes({ 0x2a, 0x47, op.x }); // sub al, [rdi + x]
+            emitter.bytes({ 0x0f, 0x93, 0xc1 }); // setnc cl
+            emitter.store_al(op.x);
+            emitter.bytes({ 0x88, 0x4f, commands::flag_register });
+            return true;
+        }
+        case (Instr::ShiftRight): {
+            if (quirks.shift_vy) {
+                emitter.load_al(op.y);
+                emitter.store_al(op.x);
+            }
+            emitter.bytes({ 0xd0, 0x6f, op.x }); // shr byte [rdi + x], 1
+            emitter.flag_from_carry(true);
+            return true;
+        }
+        case (Instr::ShiftLeft): {
+            if (quirks.shift_vy) {
+                emitter.load_al(op.y);
+                emitter.store_al(op.x);
+            }
+            emitter.bytes({ 0xd0, 0x67, op.x }); // shl byte [rdi + x], 1
+            emitter.flag_from_carry(true);
+            return true;
+        }
+        case (Instr::SetIndex): {
+            emitter.bytes({ 0x66, 0xc7, 0x06 }); // mov word [rsi], nnn
+            emitter.imm16(op.nnn);
+            return true;
+        }
+        case (Instr::AddVxToIndex): {
+            emitter.bytes({ 0x0f, 0xb6, 0x47, op.x }); // movzx eax, byte [rdi + x]
+            emitter.bytes({ 0x66, 0x01, 0x06 });       // add [rsi], ax
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// emit an instruction that ends the block, false if it is not translated
+bool emit_branch(Emitter &emitter, const Instruction &op, u16 next_pc, const QuirkSet &quirks) noexcept {
+    switch (op.kind) {
+        case (Instr::Jump): {
+            emitter.return_pc(op.nnn);
+            return true;
+        }
+        case (Instr::IfRegNotEqualValue): {
+            emitter.bytes({ 0x80, 0x7f, op.x, op.nn }); // cmp byte [rdi + x], nn
+            emitter.return_skip(next_pc, jne);
+            return true;
+        }
+        case (Instr::IfRegEqualValue): {
+            emitter.bytes({ 0x80, 0x7f, op.x, op.nn });
+            emitter.return_skip(next_pc, je);
+            return true;
+        }
+        case (Instr::IfRegNotEqualReg): {
+            emitter.bytes({ 0x8a, 0x4f, op.y }); // mov cl, [rdi + y]
+            emitter.bytes({ 0x38, 0x4f, op.x }); // cmp [rdi + x], cl
+            emitter.return_skip(next_pc, jne);
+            return true;
+        }
+        case (Instr::IfRegEquality): {
+            emitter.bytes({ 0x8a, 0x4f, op.y });
+            emitter.bytes({ 0x38, 0x4f, op.x });
+            emitter.return_skip(next_pc, je);
+            return true;
+        }
+        case (Instr::JumpV0Addr): {
+            u8 reg = quirks.jump_vx ? op.x : 0x0;
+            emitter.bytes({ 0x0f, 0xb6, 0x47, reg }); // movzx eax, byte [rdi + reg]
+            emitter.bytes({ 0x05 });                  // add eax, nnn
+            emitter.imm32(op.nnn);
+            emitter.bytes({ 0xc3 });
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+} // namespace
+
+Jit::Jit(QuirkProfile quirks) : m_quirks(quirk_set(quirks)), m_entries(default_memory_size), m_code(nullptr), m_code_size(0), m_code_used(0), m_stats() {
+#ifdef CH_JIT_X86_64
+    void *code = mmap(nullptr, code_buffer_size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code != MAP_FAILED) {
+        m_code = static_cast<u8 *>(code);
+        m_code_size = code_buffer_size;
+    }
+#endif
+}
+
+Jit::~Jit() {
+#ifdef CH_JIT_X86_64
+    if (m_code != nullptr) {
+        munmap(m_code, m_code_size);
+    }
+#endif
+}
+
+bool Jit::is_supported() noexcept {
+#ifdef CH_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+const Jit::Block *Jit::block(u16 pc, RAM<> &memory) noexcept {
+    auto &entry = m_entries.at(pc);
+    if (entry.state == State::Untranslated) {
+        entry.state = translate(pc, memory, entry) ? State::Translated : State::Interpreted;
+    }
+    return entry.state == State::Translated ? &entry.block : nullptr;
+}
+
+bool Jit::translate(u16 pc, RAM<> &memory, Entry &entry) noexcept {
+    if (m_code == nullptr) {
+        return false;
+    }
+
+    const u16 start = pc;
+    Emitter emitter;
+    u16 length = 0;
+    bool ended = false;
+    while (!ended && length < max_block_instructions && pc + 1 < default_memory_size) {
+        const auto &op = memory.fetch_decoded(pc);
+        u16 next_pc = pc + 2;
+        if (length > 0) {
+            // the interpreter carries on here when the budget runs out
+            emitter.return_if_spent(static_cast<u8>(length), pc);
+        }
+        if (emit_straight(emitter, op, m_quirks)) {
+            pc = next_pc;
+        } else if (emit_branch(emitter, op, next_pc, m_quirks)) {
+            pc = next_pc;
+            ended = true;
+        } else {
+            break;
+        }
+        ++length;
+    }
+
+    if (length == 0) {
+        return false;
+    }
+    if (!ended) {
+        emitter.return_pc(pc);
+    }
+
+    if (m_code_used + emitter.size() > m_code_size) {
+        // out of code space, start over
+        flush();
+    }
+
+    auto *code = std::next(m_code, static_cast<std::ptrdiff_t>(m_code_used));
+    std::memcpy(code, emitter.data(), emitter.size());
+    m_code_used += emitter.size();
+
+    // NOLINTNEXTLINE(*reinterpret-cast*): entering generated code
+    entry.block = Block{ .code = reinterpret_cast<BlockFn>(code), .start = start, .end = pc, .length = length };
+    return true;
+}
+
+void Jit::invalidate(u16 first, u16 last) noexcept {
+    constexpr std::size_t max_block_span = max_block_instructions * 2;
+    std::size_t begin = first > max_block_span ? first - max_block_span : 0;
+    std::size_t end = std::min<std::size_t>(last + 1, m_entries.size());
+    for (auto pc = begin; pc < end; ++pc) {
+        auto &entry = m_entries.at(pc);
+        bool translated_here = entry.state == State::Translated && entry.block.end > first;
+        // an instruction left to the interpreter may translate once rewritten
+        bool rewritten = pc + 1 >= first;
+        if (translated_here || (entry.state == State::Interpreted && rewritten)) {
+            entry.state = State::Untranslated;
+        }
+    }
+}
+
+void Jit::flush() noexcept {
+    std::fill(m_entries.begin(), m_entries.end(), Entry{});
+    m_code_used = 0;
+}
@@ -0,0 +1,90 @@
+#ifndef C8_JIT_H
+#define C8_JIT_H
+
+#include "common.h"
+#include "quirks.h"
+#include "ram.h"
+
+#include <cstddef>
+#include <vector>
+
+// translates basic blocks of ALU, index and branch instructions to native
+// x86-64 code. Anything else ends the block and is left to the interpreter.
+class Jit {
+  public:
+    // runs the block on V0-VF and the index register and returns the next pc.
+    // Stops after budget instructions when the block is longer than that
+    using BlockFn = u16 (*)(u8 *regs, u16 *index, unsigned int budget);
+
+    struct Block {
+        BlockFn code = nullptr;
+        u16 start = 0;  // address of the first instruction
+        u16 end = 0;    // address after the last instruction
+        u16 length = 0; // number of instructions, all of them run given the budget
+
+        // how many instructions a run with budget executes
+        [[nodiscard]] inline unsigned int executed(unsigned int budget) const noexcept {
+            return budget < length ? budget : length;
+        }
+    };
+
+    // native block runs so far and the instructions they executed
+    struct Stats {
+        u64 blocks = 0;
+        u64 instructions = 0;
+    };
+
+    // blocks behave like the interpreter under quirks
+    explicit Jit(QuirkProfile quirks = QuirkProfile::Chip8);
+    ~Jit();
+
+    Jit(const Jit &) = delete;
+    Jit operator=(const Jit &) = delete;
+
+    Jit(Jit &&) = delete;
+    Jit operator=(Jit &&) = delete;
+
+    // whether native code can be generated on this host
+    [[nodiscard]] static bool is_supported() noexcept;
+
+    // block starting at pc, translated on first use. nullptr when the
+    // instruction at pc has to be interpreted
+    [[nodiscard]] const Block *block(u16 pc, RAM<> &memory) noexcept;
+
+    // drop every block translated from the bytes first..last
+    void invalidate(u16 first, u16 last) noexcept;
+
+    void flush() noexcept;
+
+    inline void record_run(unsigned int instructions) noexcept {
+        ++m_stats.blocks;
+        m_stats.instructions += instructions;
+    }
+
+    [[nodiscard]] inline const Stats &stats() const noexcept {
+        return m_stats;
+    }
+
+  private:
+    enum class State : u8 {
+        Untranslated,
+        Translated,
+        Interpreted,
+    };
+
+    struct Entry {
+        State state = State::Untranslated;
+        Block block;
+    };
+
+    [[nodiscard]] bool translate(u16 pc, RAM<> &memory, Entry &entry) noexcept;
+
+    QuirkSet m_quirks;
+    std::vector<Entry> m_entries; // indexed by start address
+    u8 *m_code;
+    std::size_t m_code_size;
+    std::size_t m_code_used;
+    Stats m_stats;
+};
+
+#endif
@@ -0,0 +1,470 @@
+#ifndef C8_LOCKSTEP_H
+#define C8_LOCKSTEP_H
+
+#include "call_stack.h"
+#include "commands.h"
+#include "common.h"
+#include "decoder.h"
+#include "framebuffer.h"
+#include "ram.h"
+#include "registers.h"
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// runs Lanes instances of the same rom in lockstep. State is kept as
+// structure of arrays, lane index innermost, so every instruction is
+// executed for all lanes sharing its pc by one loop over the lanes that
+// the compiler can vectorize. Lanes that diverge wait until their pc is
+// scheduled; the lane that is furthest behind always picks the next pc.
+// Q is the Quirks policy of the rom, see quirks.h
+template <std::size_t Lanes, typename Q = DefaultQuirks>
+class Lockstep {
+    // lanes share one schedule and cannot wait for their own timer tick
+    static_assert(!Q::set.display_wait, "lockstep lanes cannot wait for the display");
+
+  public:
+    static constexpr u8 m_stack_depth = chip8_stack_depth;
+    static constexpr u8 m_num_of_keys = 16;
+
+    explicit Lockstep(gsl::span<const u8> rom) : m_memory(default_memory_size), m_v{}, m_index{}, m_flags{}, m_sp{}, m_stack{}, m_delay{}, m_sound{}, m_tick_phase{}, m_keys{}, m_key_pressed{}, m_rng{}, m_trap{}, m_executed{}, m_mask{} {
+        // lanes start from identical memory, taken from a scalar RAM
+        RAM<> memory(rom);
+        for (u16 addr = 0; addr < default_memory_size; ++addr) {
+            m_memory.at(addr).fill(memory.fetch(addr & ~1).get_byte(addr & 1 ? 0 : 1));
+        }
+        m_pc.fill(rom_start);
+        m_key_pressed.fill(-1);
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            seed(lane, static_cast<u32>(lane + 1));
+        }
+    }
+
+    // xorshift state of the lane, must not be 0
+    void seed(std::size_t lane, u32 seed) {
+        Expects(seed != 0);
+        m_rng.at(lane) = seed;
+    }
+
+    // bit k set when key k is held down
+    void set_keys(std::size_t lane, u16 keys) {
+        m_keys.at(lane) = keys;
+    }
+
+    // every lane executes count instructions, a trapped lane stops early
+    void run(unsigned int count) {
+        for (std::size_t l = 0; l < Lanes; ++l) {
+            m_executed[l] = m_trap[l] == Trap::None ? 0 : count;
+        }
+        for (;;) {
+            // the lane furthest behind decides which pc runs next
+            auto leader = std::min_element(m_executed.begin(), m_executed.end());
+            if (*leader >= count) {
+                return;
+            }
+            auto lane = static_cast<std::size_t>(std::distance(m_executed.begin(), leader));
+            u16 pc = m_pc[lane];
+            u8 high = m_memory.at(pc)[lane];
+            u8 low = m_memory.at(pc + 1)[lane];
+
+            // lanes at the same pc that have not self-modified it differently
+            for (std::size_t l = 0; l < Lanes; ++l) {
+                m_mask[l] = m_pc[l] == pc && m_executed[l] < count && m_memory[pc][l] == high && m_memory[pc + 1][l] == low;
+                m_executed[l] += m_mask[l];
+            }
+
+            execute(decode(Opcode(static_cast<u16>(high << 8 | low))));
+            tick_timers();
+        }
+    }
+
+    [[nodiscard]] Trap trap(std::size_t lane) const {
+        return m_trap.at(lane);
+    }
+
+    [[nodiscard]] u8 reg(std::size_t lane, u8 reg) const {
+        return m_v.at(reg).at(lane);
+    }
+
+    [[nodiscard]] u16 pc(std::size_t lane) const {
+        return m_pc.at(lane);
+    }
+
+    [[nodiscard]] u16 index(std::size_t lane) const {
+        return m_index.at(lane);
+    }
+
+    [[nodiscard]] const Framebuffer &framebuffer(std::size_t lane) const {
+        return m_framebuffers.at(lane);
+    }
+
+  private:
+    using LaneBytes = std::array<u8, Lanes>;
+    using LaneWords = std::array<u16, Lanes>;
+
+    static constexpr u8 vf = commands::flag_register;
+
+    // masked lane loops: f computes the new value of a lane
+    template <typename T, typename F>
+    inline void update(std::array<T, Lanes> &lanes, F f) noexcept {
+        for (std::size_t l = 0; l < Lanes; ++l) {
+            lanes[l] = m_mask[l] ? static_cast<T>(f(l)) : lanes[l];
+        }
+    }
+
+    // 8XY1 to 8XY3, which clear vf with the vf_reset quirk
+    template <typename F>
+    inline void update_bitwise(u8 x, F value) noexcept {
+        if constexpr (Q::set.vf_reset) {
+            update_with_flag(x, value, [](std::size_t) { return 0; });
+        } else {
+            update(m_v[x], value);
+        }
+    }
+
+    template <typename F>
+    inline void skip_if(F condition) noexcept {
+        update(m_pc, [&](std::size_t l) { return m_pc[l] + (condition(l) ? 4 : 2); });
+    }
+
+    // vx and vf from the values computed before either is written
+    template <typename F, typename G>
+    inline void update_with_flag(u8 x, F value, G flag) noexcept {
+        for (std::size_t l = 0; l < Lanes; ++l) {
+            u8 new_value = value(l);
+            u8 new_flag = flag(l);
+            m_v[x][l] = m_mask[l] ? new_value : m_v[x][l];
+            m_v[vf][l] = m_mask[l] ? new_flag : m_v[vf][l];
+        }
+    }
+
+    inline void next() noexcept {
+        update(m_pc, [&](std::size_t l) { return m_pc[l] + 2; });
+    }
+
+    void execute(const Instruction &op) {
+        auto &vx = m_v.at(op.x);
+        const auto &vy = m_v.at(op.y);
+
+        switch (op.kind) {
+            case (Instr::Jump): {
+                update(m_pc, [&](std::size_t) { return op.nnn; });
+                return;
+            }
+            case (Instr::IfRegNotEqualValue): {
+                skip_if([&](std::size_t l) { return vx[l] == op.nn; });
+                return;
+            }
+            case (Instr::IfRegEqualValue): {
+                skip_if([&](std::size_t l) { return vx[l] != op.nn; });
+                return;
+            }
+            case (Instr::IfRegNotEqualReg): {
+                skip_if([&](std::size_t l) { return vx[l] == vy[l]; });
+                return;
+            }
+            case (Instr::IfRegEquality): {
+                skip_if([&](std::size_t l) { return vx[l] != vy[l]; });
+                return;
+            }
+            case (Instr::IfKeyNotPressed): {
+                skip_if([&](std::size_t l) { return is_pressed(l, vx[l]); });
+                return;
+            }
+            case (Instr::IfKeyPressed): {
+                skip_if([&](std::size_t l) { return !is_pressed(l, vx[l]); });
+                return;
+            }
+            case (Instr::JumpV0Addr): {
+                const auto &offset = Q::set.jump_vx ? vx : m_v[0];
+                update(m_pc, [&](std::size_t l) { return op.nnn + offset[l]; });
+                return;
+            }
+            case (Instr::Call):
+            case (Instr::Return):
+            case (Instr::SetVxKey): {
+                next();
+                per_lane(op);
+                return;
+            }
+            default:
+                break;
+        }
+
+        next();
+        switch (op.kind) {
+            case (Instr::SetRegValue): {
+                update(vx, [&](std::size_t) { return op.nn; });
+                break;
+            }
+            case (Instr::AddToReg): {
+                update(vx, [&](std::size_t l) { return vx[l] + op.nn; });
+                break;
+            }
+            case (Instr::Set): {
+                update(vx, [&](std::size_t l) { return vy[l]; });
+                break;
+            }
+            case (Instr::BitwiseOr): {
+                update_bitwise(op.x, [&](std::size_t l) { return vx[l] | vy[l]; });
+                break;
+            }
+            case (Instr::BitwiseAnd): {
+                update_bitwise(op.x, [&](std::size_t l) { return vx[l] & vy[l]; });
+                break;
+            }
+            case (Instr::BitwiseXor): {
+                update_bitwise(op.x, [&](std::size_t l) { return vx[l] ^ vy[l]; });
+                break;
+            }
+            case (Instr::Addition): {
+                update_with_flag(op.x, [&](std::size_t l) { return vx[l] + vy[l]; }, [&](std::size_t l) { return vx[l] + vy[l] > 0xff ? 1 : 0; });
+                break;
+            }
+            case (Instr::Subtraction): {
+                update_with_flag(op.x, [&](std::size_t l) { return vx[l] - vy[l]; }, [&](std::size_t l) { return vx[l] >= vy[l] ? 1 : 0; });
+                break;
+            }
+            case (Instr::AltSubtraction): {
+                update_with_flag(op.x, [&](std::size_t l) { return vy[l] - vx[l]; }, [&](std::size_t l) { return vy[l] >= vx[l] ? 1 : 0; });
+                break;
+            }
+            case (Instr::ShiftRight): {
+                const auto &source = Q::set.shift_vy ? vy : vx;
+                update_with_flag(op.x, [&](std::size_t l) { return source[l] >> 1; }, [&](std::size_t l) { return source[l] & 0x1; });
+                break;
+            }
+            case (Instr::ShiftLeft): {
+                const auto &source = Q::set.shift_vy ? vy : vx;
+                update_with_flag(op.x, [&](std::size_t l) { return source[l] << 1; }, [&](std::size_t l) { return source[l] >> 7; });
+                break;
+            }
+            case (Instr::SetIndex): {
+                update(m_index, [&](std::size_t) { return op.nnn; });
+                break;
+            }
+            case (Instr::RandomNumber): {
+                for (std::size_t l = 0; l < Lanes; ++l) {
+                    u32 state = m_rng[l];
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+                    m_rng[l] = m_mask[l] ? state : m_rng[l];
+                }
+                update(vx, [&](std::size_t l) { return m_rng[l] & op.nn; });
+                break;
+            }
+            case (Instr::SetVxDelay): {
+                update(vx, [&](std::size_t l) { return m_delay[l]; });
+                break;
+            }
+            case (Instr::SetDelay): {
+                update(m_delay, [&](std::size_t l) { return vx[l]; });
+                break;
+            }
+            case (Instr::SetBuzzer): {
+                update(m_sound, [&](std::size_t l) { return vx[l]; });
+                break;
+            }
+            case (Instr::AddVxToIndex): {
+                update(m_index, [&](std::size_t l) { return m_index[l] + vx[l]; });
+                break;
+            }
+            case (Instr::SetIndexToHex): {
+                update(m_index, [&](std::size_t l) { return font_start + (vx[l] & 0xf) * bytes_per_ch; });
+                break;
+            }
+            case (Instr::SetIndexToBigHex): {
+                update(m_index, [&](std::size_t l) { return big_font_start + (vx[l] & 0xf) * big_bytes_per_ch; });
+                break;
+            }
+            default: {
+                per_lane(op);
+                break;
+            }
+        }
+    }
+
+    [[nodiscard]] inline bool is_pressed(std::size_t lane, u8 key) const {
+        Expects(key < m_num_of_keys);
+        return (m_keys[lane] >> key & 1) != 0;
+    }
+
+    // timers of the lanes that just executed, ticked like CPU::run does
+    inline void tick_timers() noexcept {
+        for (std::size_t l = 0; l < Lanes; ++l) {
+            u16 phase = m_tick_phase[l] + (m_mask[l] ? timer_hz : 0);
+            bool tick = phase >= instr_per_sec;
+            m_tick_phase[l] = tick ? phase - instr_per_sec : phase;
+            m_delay[l] -= tick && m_delay[l] > 0 ? 1 : 0;
+            m_sound[l] -= tick && m_sound[l] > 0 ? 1 : 0;
+        }
+    }
+
+    // the lane stops at the instruction that raised trap
+    void raise(std::size_t lane, Trap trap) noexcept {
+        m_pc[lane] -= 2;
+        m_trap[lane] = trap;
+        m_executed[lane] = std::numeric_limits<unsigned int>::max();
+    }
+
+    // instructions touching per lane memory, stack or screen
+    void per_lane(const Instruction &op) {
+        for (std::size_t l = 0; l < Lanes; ++l) {
+            if (m_mask[l]) {
+                execute_lane(op, l);
+            }
+        }
+    }
+
+    void execute_lane(const Instruction &op, std::size_t l) {
+        auto &vx = m_v.at(op.x)[l];
+        auto index = m_index[l];
+        switch (op.kind) {
+            case (Instr::Clear): {
+                m_framebuffers[l].clear();
+                break;
+            }
+            case (Instr::ScrollDown): {
+                m_framebuffers[l].scroll_down(op.n);
+                break;
+            }
+            case (Instr::ScrollRight): {
+                m_framebuffers[l].scroll_right();
+                break;
+            }
+            case (Instr::ScrollLeft): {
+                m_framebuffers[l].scroll_left();
+                break;
+            }
+            case (Instr::LowRes):
+            case (Instr::HighRes): {
+                m_framebuffers[l].set_high_res(op.kind == Instr::HighRes);
+                break;
+            }
+            case (Instr::Exit): {
+                raise(l, Trap::Exit);
+                break;
+            }
+            case (Instr::Call): {
+                if (m_sp[l] == m_stack_depth) {
+                    raise(l, Trap::StackOverflow);
+                    break;
+                }
+                m_stack.at(m_sp[l]++)[l] = m_pc[l];
+                m_pc[l] = op.nnn;
+                break;
+            }
+            case (Instr::Return): {
+                if (m_sp[l] == 0) {
+                    raise(l, Trap::StackUnderflow);
+                    break;
+                }
+                m_pc[l] = m_stack.at(--m_sp[l])[l];
+                break;
+            }
+            case (Instr::LoadSprite): {
+                // gather the lane's rows, wrapping around the end of memory
+                u8 size = op.n == 0 ? large_sprite_size : op.n;
+                std::array<u8, large_sprite_size> rows{};
+                for (u8 i = 0; i < size; ++i) {
+                    rows.at(i) = m_memory.at((index + i) % default_memory_size)[l];
+                }
+                Sprite sprite(gsl::span<const u8>(rows).first(size));
+                auto &framebuffer = m_framebuffers[l];
+                auto y = m_v.at(op.y)[l];
+                bool has_flipped = op.n == 0 ? framebuffer.template draw_large_sprite<Q::set.wrap_sprites>(sprite, vx, y) : framebuffer.template draw_sprite<Q::set.wrap_sprites>(sprite, vx, y);
+                m_v[vf][l] = static_cast<u8>(has_flipped);
+                break;
+            }
+            case (Instr::SetVxKey): {
+                auto &key_pressed = m_key_pressed[l];
+                if (key_pressed == -1) {
+                    for (u8 k = 0; k < m_num_of_keys; ++k) {
+                        if (is_pressed(l, k)) {
+                            key_pressed = static_cast<i8>(k);
+                            break;
+                        }
+                    }
+                    if (key_pressed != -1) {
+                        vx = key_pressed;
+                    }
+                    m_pc[l] -= 2;
+                } else if (is_pressed(l, key_pressed)) {
+                    m_pc[l] -= 2;
+                } else {
+                    key_pressed = -1;
+                }
+                break;
+            }
+            case (Instr::BcdVx): {
+                constexpr int base10 = 10;
+                m_memory.at(index)[l] = vx / (base10 * base10);
+                m_memory.at(index + 1)[l] = (vx / base10) % base10;
+                m_memory.at(index + 2)[l] = vx % base10;
+                break;
+            }
+            case (Instr::StoreToRam): {
+                for (u8 reg = 0; reg <= op.x; ++reg) {
+                    m_memory.at(index + reg)[l] = m_v[reg][l];
+                }
+                if constexpr (Q::set.increment_index) {
+                    m_index[l] = index + op.x + 1;
+                }
+                break;
+            }
+            case (Instr::LoadFromRam): {
+                for (u8 reg = 0; reg <= op.x; ++reg) {
+                    m_v[reg][l] = m_memory.at(index + reg)[l];
+                }
+                if constexpr (Q::set.increment_index) {
+                    m_index[l] = index + op.x + 1;
+                }
+                break;
+            }
+            case (Instr::StoreFlags): {
+                for (u8 reg = 0; reg <= op.x; ++reg) {
+                    m_flags[reg][l] = m_v[reg][l];
+                }
+                break;
+            }
+            case (Instr::LoadFlags): {
+                for (u8 reg = 0; reg <= op.x; ++reg) {
+                    m_v[reg][l] = m_flags[reg][l];
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    std::vector<LaneBytes> m_memory; // m_memory[addr][lane]
+    std::array<LaneBytes, Registers::m_number_of_registers> m_v;
+    LaneWords m_pc;
+    LaneWords m_index;
+    std::array<LaneBytes, rpl_flag_count> m_flags;
+
+    LaneBytes m_sp;
+    std::array<LaneWords, m_stack_depth> m_stack;
+
+    LaneBytes m_delay;
+    LaneBytes m_sound;
+    LaneWords m_tick_phase;
+
+    std::array<u16, Lanes> m_keys;
+    std::array<i8, Lanes> m_key_pressed;
+    std::array<u32, Lanes> m_rng;
+    std::array<Trap, Lanes> m_trap;
+    std::array<Framebuffer, Lanes> m_framebuffers;
+
+    std::array<unsigned int, Lanes> m_executed;
+    LaneBytes m_mask;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include <chip8/chip8.h>
+
+#include "cpu.h"
+#include "null_frontend.h"
+
+struct Machine::Impl {
+    Impl(std::span<const std::uint8_t> rom, QuirkProfile quirks) : cpu(gsl::span<const u8>(rom.data(), rom.size()), frontend, default_dispatch, quirks) {}
+
+    NullFrontend frontend;
+    CPU cpu;
+};
+
+Machine::Machine(std::span<const std::uint8_t> rom, unsigned int instr_per_frame, QuirkProfile quirks) : m_impl(std::make_unique<Impl>(rom, quirks)) {
+    if (instr_per_frame > 0) {
+        m_impl->cpu.set_instr_per_frame(instr_per_frame);
+    }
+}
+
+Machine::~Machine() = default;
+
+Machine::Machine(Machine &&) noexcept = default;
+Machine &Machine::operator=(Machine &&) noexcept = default;
+
+unsigned int Machine::step(unsigned int count) {
+    return m_impl->cpu.run(count);
+}
+
+unsigned int Machine::run_frames(unsigned int frames) {
+    unsigned int executed = 0;
+    for (unsigned int frame = 0; frame < frames && !m_impl->cpu.is_trapped(); ++frame) {
+        executed += m_impl->cpu.step_frame();
+    }
+    return executed;
+}
+
+void Machine::set_keys(std::uint16_t mask) noexcept {
+    m_impl->frontend.set_keys(mask);
+}
+
+void Machine::seed(std::uint32_t seed) noexcept {
+    m_impl->cpu.seed(seed);
+}
+
+ScreenView Machine::screen() const noexcept {
+    const auto &framebuffer = m_impl->cpu.framebuffer();
+    auto words = framebuffer.words();
+    return ScreenView{ { words.data(), words.size() }, framebuffer.width(), framebuffer.height() };
+}
+
+MachineState Machine::state() const noexcept {
+    const auto &cpu = m_impl->cpu;
+    const auto &regs = cpu.registers();
+    auto v = regs.get_regs_span();
+    auto stack = cpu.stack().entries();
+    auto memory = cpu.memory().data();
+    return MachineState{
+        { v.data(), v.size() },
+        regs.get_pc(),
+        regs.get_index(),
+        regs.get_timer(),
+        regs.get_sound(),
+        { stack.data(), stack.size() },
+        { memory.data(), memory.size() },
+        cpu.is_trapped(),
+    };
+}
@@ -0,0 +1,364 @@
+#include "movie.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+constexpr u64 offset_basis = 0xcbf29ce484222325;
+constexpr u64 prime = 0x100000001b3;
+
+class Fnv {
+  public:
+    void mix(u64 value, std::size_t bytes) noexcept {
+        for (std::size_t i = 0; i < bytes; ++i) {
+            m_hash ^= value >> (8 * i) & 0xff;
+            m_hash *= prime;
+        }
+    }
+
+    [[nodiscard]] u64 hash() const noexcept {
+        return m_hash;
+    }
+
+  private:
+    u64 m_hash = offset_basis;
+};
+
+// little endian, whatever the host
+void put(std::vector<u8> &out, u64 value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<u8>(value >> (8 * i)));
+    }
+}
+
+// 7 bits per byte, the high bit set on all but the last
+void put_varint(std::vector<u8> &out, u32 value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<u8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<u8>(value));
+}
+
+class Reader {
+  public:
+    explicit Reader(const std::vector<u8> &in) : m_in(in), m_pos(0) {}
+
+    u64 get(std::size_t bytes) {
+        if (m_in.size() - m_pos < bytes) {
+            throw std::runtime_error("movie file is truncated");
+        }
+        u64 value = 0;
+        for (std::size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<u64>(m_in[m_pos++]) << (8 * i);
+        }
+        return value;
+    }
+
+    u32 get_varint() {
+        u32 value = 0;
+        for (unsigned int shift = 0; shift < 32; shift += 7) {
+            auto byte = get(1);
+            value |= static_cast<u32>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("movie file is corrupt");
+    }
+
+  private:
+    const std::vector<u8> &m_in;
+    std::size_t m_pos;
+};
+} // namespace
+
+u64 state_hash(const Snapshot &snapshot) noexcept {
+    Fnv fnv;
+    for (auto byte : snapshot.memory) {
+        fnv.mix(byte, 1);
+    }
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        fnv.mix(snapshot.regs.at(reg), 1);
+    }
+    for (auto flag : snapshot.flags) {
+        fnv.mix(flag, 1);
+    }
+    fnv.mix(snapshot.regs.get_pc(), 2);
+    fnv.mix(snapshot.regs.get_index(), 2);
+    fnv.mix(snapshot.regs.get_timer(), 1);
+    fnv.mix(snapshot.regs.get_sound(), 1);
+    fnv.mix(snapshot.stack.sp(), 1);
+    for (auto addr : snapshot.stack.entries()) {
+        fnv.mix(addr, 2);
+    }
+    fnv.mix(static_cast<u8>(snapshot.framebuffer.is_high_res()), 1);
+    for (auto word : snapshot.framebuffer.words()) {
+        fnv.mix(word, 8);
+    }
+    fnv.mix(snapshot.rng.state(), 4);
+    fnv.mix(static_cast<u8>(snapshot.trap.kind), 1);
+    fnv.mix(snapshot.trap.pc, 2);
+    fnv.mix(static_cast<u8>(snapshot.key_pressed), 1);
+    fnv.mix(static_cast<u8>(snapshot.display_wait), 1);
+    fnv.mix(snapshot.instr_per_sec, 4);
+    fnv.mix(snapshot.tick_phase, 4);
+    fnv.mix(snapshot.frame_phase, 4);
+    return fnv.hash();
+}
+
+u64 rom_hash(gsl::span<const u8> rom) noexcept {
+    Fnv fnv;
+    for (auto byte : rom) {
+        fnv.mix(byte, 1);
+    }
+    return fnv.hash();
+}
+
+Movie::Movie(gsl::span<const u8> rom, u32 seed, unsigned int instr_per_frame, unsigned int keyframe_interval, QuirkProfile quirks) : m_rom_hash(rom_hash(rom)), m_seed(seed), m_instr_per_frame(instr_per_frame), m_quirks(quirks), m_keyframe_interval(keyframe_interval) {
+    Expects(instr_per_frame > 0);
+}
+
+void Movie::record(const CPU &cpu, u16 keys) {
+    if (m_keyframe_interval > 0 && m_frames % m_keyframe_interval == 0) {
+        auto snapshot = std::make_unique<Snapshot>();
+        cpu.save(*snapshot);
+        auto bytes = snapshot_bytes(*snapshot);
+        m_keyframes.push_back(Keyframe{ m_frames, state_hash(*snapshot), 0 });
+        m_recorded.emplace_back(bytes.begin(), bytes.end());
+    }
+
+    if (m_changes.empty() ? keys != 0 : keys != m_changes.back().keys) {
+        m_changes.push_back(KeyChange{ m_frames, keys });
+    }
+    ++m_frames;
+}
+
+void Movie::finish(const Snapshot &final_state) noexcept {
+    m_final_hash = state_hash(final_state);
+}
+
+u16 Movie::keys_at(u32 frame) const noexcept {
+    auto next = std::upper_bound(m_changes.begin(), m_changes.end(), frame, [](u32 f, const KeyChange &change) { return f < change.frame; });
+    return next == m_changes.begin() ? 0 : std::prev(next)->keys;
+}
+
+std::size_t Movie::keyframe_before(u32 frame) const noexcept {
+    auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), frame, [](u32 f, const Keyframe &keyframe) { return f < keyframe.frame; });
+    return next == m_keyframes.begin() ? m_keyframes.size() : static_cast<std::size_t>(std::distance(m_keyframes.begin(), next) - 1);
+}
+
+void Movie::keyframe(std::size_t i, Snapshot &snapshot) const {
+    Expects(i < m_keyframes.size());
+    if (i < m_recorded.size()) {
+        snapshot_from_bytes(m_recorded[i], snapshot);
+        return;
+    }
+
+    std::vector<u8> bytes(sizeof(Snapshot));
+    std::ifstream file(m_path, std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(m_keyframes[i].offset));
+    if (!file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error("cannot read keyframe from " + m_path.string());
+    }
+    snapshot_from_bytes(bytes, snapshot);
+}
+
+// header, every change as its distance to the previous one and the keys, the
+// keyframe snapshots, their index and last where the index starts
+void Movie::save(const std::filesystem::path &path) const {
+    std::vector<u8> out;
+    put(out, movie_magic, 4);
+    put(out, movie_version, 2);
+    put(out, m_rom_hash, 8);
+    put(out, m_seed, 4);
+    put(out, m_instr_per_frame, 4);
+    put(out, static_cast<u8>(m_quirks), 1);
+    put(out, m_frames, 4);
+    put(out, m_final_hash, 8);
+    put(out, m_keyframe_interval, 4);
+    put(out, m_changes.size(), 4);
+
+    u32 frame = 0;
+    for (const auto &change : m_changes) {
+        put_varint(out, change.frame - frame);
+        put(out, change.keys, 2);
+        frame = change.frame;
+    }
+
+    // snapshots are written in the layout of this build, see snapshot.h
+    auto snapshot = std::make_unique<Snapshot>();
+    std::vector<u64> offsets;
+    for (std::size_t i = 0; i < m_keyframes.size(); ++i) {
+        keyframe(i, *snapshot);
+        auto bytes = snapshot_bytes(*snapshot);
+        offsets.push_back(out.size());
+        out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+
+    auto index = out.size();
+    for (std::size_t i = 0; i < m_keyframes.size(); ++i) {
+        put(out, m_keyframes[i].frame, 4);
+        put(out, m_keyframes[i].hash, 8);
+        put(out, offsets[i], 8);
+    }
+    put(out, m_keyframes.size(), 4);
+    put(out, index, 8);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size()))) {
+        throw std::runtime_error("cannot write movie " + path.string());
+    }
+}
+
+Movie Movie::load(const std::filesystem::path &path) {
+    constexpr std::size_t trailer_size = 12;
+    constexpr std::size_t index_entry_size = 20;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("cannot open movie " + path.string());
+    }
+    auto file_size = static_cast<u64>(file.tellg());
+    auto read = [&file, &path](u64 offset, u64 size) {
+        std::vector<u8> bytes(size);
+        file.seekg(static_cast<std::streamoff>(offset));
+        if (!file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("cannot read movie " + path.string());
+        }
+        return bytes;
+    };
+    if (file_size < trailer_size) {
+        throw std::runtime_error(path.string() + " is not a movie of this version");
+    }
+
+    // the index first, so keyframes can stay in the file
+    Movie movie;
+    movie.m_path = path;
+    auto trailer = read(file_size - trailer_size, trailer_size);
+    Reader trailer_reader(trailer);
+    auto keyframes = trailer_reader.get(4);
+    auto index = trailer_reader.get(8);
+    if (index > file_size - trailer_size || (file_size - trailer_size - index) != keyframes * index_entry_size) {
+        throw std::runtime_error(path.string() + " is not a movie of this version");
+    }
+
+    auto index_bytes = read(index, keyframes * index_entry_size);
+    Reader index_reader(index_bytes);
+    for (u64 i = 0; i < keyframes; ++i) {
+        Keyframe keyframe{};
+        keyframe.frame = static_cast<u32>(index_reader.get(4));
+        keyframe.hash = index_reader.get(8);
+        keyframe.offset = index_reader.get(8);
+        if (keyframe.offset + sizeof(Snapshot) > index || (i > 0 && keyframe.frame <= movie.m_keyframes.back().frame)) {
+            throw std::runtime_error("movie file is corrupt");
+        }
+        movie.m_keyframes.push_back(keyframe);
+    }
+
+    auto header = read(0, movie.m_keyframes.empty() ? index : movie.m_keyframes.front().offset);
+    Reader reader(header);
+    if (reader.get(4) != movie_magic || reader.get(2) != movie_version) {
+        throw std::runtime_error(path.string() + " is not a movie of this version");
+    }
+
+    movie.m_rom_hash = reader.get(8);
+    movie.m_seed = static_cast<u32>(reader.get(4));
+    movie.m_instr_per_frame = static_cast<unsigned int>(reader.get(4));
+    auto quirks = reader.get(1);
+    if (quirks >= quirk_profile_count) {
+        throw std::runtime_error("movie file is corrupt");
+    }
+    movie.m_quirks = static_cast<QuirkProfile>(quirks);
+    movie.m_frames = static_cast<u32>(reader.get(4));
+    movie.m_final_hash = reader.get(8);
+    movie.m_keyframe_interval = static_cast<unsigned int>(reader.get(4));
+
+    auto count = reader.get(4);
+    u32 frame = 0;
+    for (u64 i = 0; i < count; ++i) {
+        frame += reader.get_varint();
+        auto keys = static_cast<u16>(reader.get(2));
+        if (frame >= movie.m_frames || (i > 0 && frame <= movie.m_changes.back().frame)) {
+            throw std::runtime_error("movie file is corrupt");
+        }
+        movie.m_changes.push_back(KeyChange{ frame, keys });
+    }
+    if (movie.m_instr_per_frame == 0 || (!movie.m_keyframes.empty() && movie.m_keyframes.back().frame > movie.m_frames)) {
+        throw std::runtime_error("movie file is corrupt");
+    }
+    return movie;
+}
+
+void prepare_replay(const Movie &movie, CPU &cpu) noexcept {
+    cpu.seed(movie.seed());
+    cpu.set_instr_per_frame(movie.instr_per_frame());
+}
+
+void replay(const Movie &movie, CPU &cpu, NullFrontend &frontend, u32 from, u32 to) {
+    Expects(from <= to && to <= movie.frames());
+
+    const auto &changes = movie.changes();
+    auto next = std::upper_bound(changes.begin(), changes.end(), from, [](u32 f, const KeyChange &change) { return f < change.frame; });
+    frontend.set_keys(movie.keys_at(from));
+
+    for (u32 frame = from; frame < to && !cpu.is_trapped(); ++frame) {
+        if (next != changes.end() && next->frame == frame) {
+            frontend.set_keys(next->keys);
+            ++next;
+        }
+        cpu.step_frame();
+    }
+}
+
+void seek(const Movie &movie, CPU &cpu, NullFrontend &frontend, u32 frame) {
+    auto keyframe = movie.keyframe_before(frame);
+    if (keyframe == movie.keyframes().size()) {
+        prepare_replay(movie, cpu);
+        replay(movie, cpu, frontend, 0, frame);
+        return;
+    }
+
+    auto snapshot = std::make_unique<Snapshot>();
+    movie.keyframe(keyframe, *snapshot);
+    cpu.load(*snapshot);
+    replay(movie, cpu, frontend, movie.keyframes()[keyframe].frame, frame);
+}
+
+bool verify_segment(const Movie &movie, gsl::span<const u8> rom, std::size_t segment) {
+    Expects(segment < movie.segments());
+    const auto &keyframes = movie.keyframes();
+
+    NullFrontend frontend;
+    CPU cpu(rom, frontend, default_dispatch, movie.quirks());
+    auto snapshot = std::make_unique<Snapshot>();
+    u32 from = 0;
+    if (keyframes.empty()) {
+        prepare_replay(movie, cpu);
+    } else {
+        movie.keyframe(segment, *snapshot);
+        cpu.load(*snapshot);
+        from = keyframes[segment].frame;
+    }
+
+    // the first keyframe must also be where a fresh machine starts
+    if (segment == 0 && !keyframes.empty()) {
+        NullFrontend fresh_frontend;
+        CPU fresh(rom, fresh_frontend, default_dispatch, movie.quirks());
+        prepare_replay(movie, fresh);
+        fresh.save(*snapshot);
+        if (keyframes.front().frame != 0 || state_hash(*snapshot) != keyframes.front().hash) {
+            return false;
+        }
+    }
+
+    bool last = segment + 1 >= movie.segments();
+    u32 to = last ? movie.frames() : keyframes[segment + 1].frame;
+    replay(movie, cpu, frontend, from, to);
+
+    cpu.save(*snapshot);
+    return state_hash(*snapshot) == (last ? movie.final_hash() : keyframes[segment + 1].hash);
+}
@@ -0,0 +1,145 @@
+#ifndef C8_MOVIE_H
+#define C8_MOVIE_H
+
+#include "common.h"
+#include "cpu.h"
+#include "null_frontend.h"
+#include "snapshot.h"
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+constexpr u32 movie_magic = 0x4d384843; // "CH8M" in little endian
+constexpr u16 movie_version = 5;
+
+// keys held from frame on, until the next change
+struct KeyChange {
+    u32 frame;
+    u16 keys;
+};
+
+// full machine state at the start of frame, hash is its state_hash and
+// offset where the snapshot is stored in the movie file
+struct Keyframe {
+    u32 frame;
+    u64 hash;
+    u64 offset;
+};
+
+// FNV-1a over everything a snapshot restores, equal for equal machines no
+// matter the padding bytes or the build
+[[nodiscard]] u64 state_hash(const Snapshot &snapshot) noexcept;
+[[nodiscard]] u64 rom_hash(gsl::span<const u8> rom) noexcept;
+
+// input of one virtual clock session: the rom, the rng seed, speed and quirks
+// it ran with and every change of the held keys, tagged with its frame. Keys only
+// change between frames, so replaying it gives the very same machine.
+//
+// Optionally a snapshot is embedded every keyframe_interval frames, indexed
+// at the end of the file. Any frame is then reached by loading one keyframe
+// and replaying less than keyframe_interval frames, and the segments between
+// keyframes can be verified independently. Keyframes are only read from the
+// file when asked for, and only by builds with the same snapshot layout
+class Movie {
+  public:
+    Movie(gsl::span<const u8> rom, u32 seed, unsigned int instr_per_frame, unsigned int keyframe_interval = 0, QuirkProfile quirks = QuirkProfile::Chip8);
+
+    // keys held during the next frame, cpu is the state it starts from
+    void record(const CPU &cpu, u16 keys);
+    // state after the last recorded frame, replays are checked against it
+    void finish(const Snapshot &final_state) noexcept;
+
+    void save(const std::filesystem::path &path) const;
+    // throws if the file is not a movie of this version
+    [[nodiscard]] static Movie load(const std::filesystem::path &path);
+
+    [[nodiscard]] inline bool is_for(gsl::span<const u8> rom) const noexcept {
+        return rom_hash(rom) == m_rom_hash;
+    }
+
+    [[nodiscard]] inline u32 seed() const noexcept {
+        return m_seed;
+    }
+
+    [[nodiscard]] inline unsigned int instr_per_frame() const noexcept {
+        return m_instr_per_frame;
+    }
+
+    // replaying CPUs have to be built with these
+    [[nodiscard]] inline QuirkProfile quirks() const noexcept {
+        return m_quirks;
+    }
+
+    [[nodiscard]] inline u32 frames() const noexcept {
+        return m_frames;
+    }
+
+    [[nodiscard]] inline u64 final_hash() const noexcept {
+        return m_final_hash;
+    }
+
+    [[nodiscard]] inline const std::vector<KeyChange> &changes() const noexcept {
+        return m_changes;
+    }
+
+    // keys held during frame
+    [[nodiscard]] u16 keys_at(u32 frame) const noexcept;
+
+    [[nodiscard]] inline const std::vector<Keyframe> &keyframes() const noexcept {
+        return m_keyframes;
+    }
+
+    // latest keyframe at or before frame, keyframes().size() if none
+    [[nodiscard]] std::size_t keyframe_before(u32 frame) const noexcept;
+
+    // snapshot of keyframes()[i], throws if it cannot be read or was saved
+    // by a build with another snapshot layout
+    void keyframe(std::size_t i, Snapshot &snapshot) const;
+
+    // parts verify_segment checks independently, one per keyframe
+    [[nodiscard]] inline std::size_t segments() const noexcept {
+        return std::max<std::size_t>(m_keyframes.size(), 1);
+    }
+
+  private:
+    Movie() = default;
+
+    u64 m_rom_hash = 0;
+    u32 m_seed = 0;
+    unsigned int m_instr_per_frame = 0;
+    QuirkProfile m_quirks = QuirkProfile::Chip8;
+    u32 m_frames = 0;
+    u64 m_final_hash = 0;
+    std::vector<KeyChange> m_changes;
+
+    unsigned int m_keyframe_interval = 0;
+    std::vector<Keyframe> m_keyframes;
+    // snapshots of keyframes recorded in this session, loaded movies read
+    // theirs from m_path instead
+    std::vector<std::vector<u8>> m_recorded;
+    std::filesystem::path m_path;
+};
+
+// set up cpu, fresh from the movie's rom with its quirks, the way the
+// recording started
+void prepare_replay(const Movie &movie, CPU &cpu) noexcept;
+
+// run frames [from, to) of movie on cpu with the recorded keys, as fast as
+// the host can. frontend is the one cpu reads its input from
+void replay(const Movie &movie, CPU &cpu, NullFrontend &frontend, u32 from, u32 to);
+
+// bring cpu to the start of frame from the latest keyframe before it. Without
+// one the replay starts over, which needs cpu fresh from the movie's rom
+// with its quirks
+void seek(const Movie &movie, CPU &cpu, NullFrontend &frontend, u32 frame);
+
+// replay segment on a machine of its own from its keyframe to the next one,
+// or the end of the movie. True when it ends on the recorded state. Segments
+// share nothing, so they can be verified on as many threads as there are
+[[nodiscard]] bool verify_segment(const Movie &movie, gsl::span<const u8> rom, std::size_t segment);
+
+#endif
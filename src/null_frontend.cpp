@@ -0,0 +1,21 @@
+#include "null_frontend.h"
+
+NullFrontend::NullFrontend() : m_keys_pressed{ false }, m_presented_frames(0) {}
+
+void NullFrontend::present([[maybe_unused]] const Framebuffer &framebuffer) noexcept {
+    ++m_presented_frames;
+}
+
+bool NullFrontend::is_pressed(u8 key) const noexcept {
+    return m_keys_pressed.at(key);
+}
+
+void NullFrontend::set_key(u8 key, bool pressed) noexcept {
+    m_keys_pressed.at(key) = pressed;
+}
+
+void NullFrontend::set_keys(u16 mask) noexcept {
+    for (u8 key = 0; key < m_num_of_keys; ++key) {
+        m_keys_pressed.at(key) = (mask >> key & 1) != 0;
+    }
+}
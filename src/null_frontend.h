@@ -0,0 +1,37 @@
+#ifndef C8_NULL_FRONTEND_H
+#define C8_NULL_FRONTEND_H
+
+#include "common.h"
+#include "frontend.h"
+
+#include <array>
+
+// headless frontend: nothing is drawn, keys are set by the caller
+class NullFrontend : public Frontend {
+  public:
+    NullFrontend();
+
+    void present(const Framebuffer &framebuffer) noexcept override;
+    void poll_events() noexcept override {}
+
+    [[nodiscard]] bool is_pressed(u8 key) const noexcept override;
+    [[nodiscard]] bool should_close() const noexcept override {
+        return false;
+    }
+
+    void set_key(u8 key, bool pressed) noexcept;
+    // all keys at once from a key_mask
+    void set_keys(u16 mask) noexcept;
+
+    [[nodiscard]] inline unsigned long presented_frames() const noexcept {
+        return m_presented_frames;
+    }
+
+  private:
+    static constexpr u8 m_num_of_keys = 16;
+    std::array<bool, m_num_of_keys> m_keys_pressed;
+
+    unsigned long m_presented_frames;
+};
+
+#endif
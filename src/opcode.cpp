@@ -1,4 +1,6 @@
-#include "ram.h"
+#include "opcode.h"
+
+#include <iostream>
 
 Opcode::Opcode(u16 op) : m_opcode(op) {}
 
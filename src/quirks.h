@@ -0,0 +1,81 @@
+#ifndef C8_QUIRKS_H
+#define C8_QUIRKS_H
+
+#include "common.h"
+
+#include <chip8/chip8.h>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+constexpr std::size_t quirk_profile_count = 4;
+
+// instructions that behave differently between interpreters
+struct QuirkSet {
+    bool shift_vy;        // 8XY6 and 8XYE shift vy into vx instead of shifting vx
+    bool jump_vx;         // BXNN jumps to XNN + vx instead of NNN + v0
+    bool vf_reset;        // 8XY1, 8XY2 and 8XY3 clear vf
+    bool increment_index; // FX55 and FX65 leave the index at I + x + 1
+    bool wrap_sprites;    // sprites wrap around the screen edges instead of being clipped
+    bool display_wait;    // DXYN waits for the next 60 Hz tick before anything else runs
+};
+
+[[nodiscard]] constexpr QuirkSet quirk_set(QuirkProfile profile) noexcept {
+    switch (profile) {
+        case (QuirkProfile::CosmacVip):
+            return { .shift_vy = true, .jump_vx = false, .vf_reset = true, .increment_index = true, .wrap_sprites = false, .display_wait = true };
+        case (QuirkProfile::SuperChip):
+            return { .shift_vy = false, .jump_vx = true, .vf_reset = false, .increment_index = false, .wrap_sprites = false, .display_wait = false };
+        case (QuirkProfile::XoChip):
+            return { .shift_vy = true, .jump_vx = false, .vf_reset = false, .increment_index = true, .wrap_sprites = true, .display_wait = false };
+        case (QuirkProfile::Chip8):
+            break;
+    }
+    return { .shift_vy = false, .jump_vx = false, .vf_reset = true, .increment_index = false, .wrap_sprites = false, .display_wait = false };
+}
+
+// compile time policy the commands and interpreters are specialized on, so
+// a quirk costs no branch when running
+template <QuirkProfile Profile>
+struct Quirks {
+    static constexpr QuirkProfile profile = Profile;
+    static constexpr QuirkSet set = quirk_set(Profile);
+};
+
+using DefaultQuirks = Quirks<QuirkProfile::Chip8>;
+
+// call f.template operator()<Quirks<profile>>(), picking the
+// specialization once for the given runtime profile
+template <typename F>
+decltype(auto) with_quirks(QuirkProfile profile, F &&f) {
+    switch (profile) {
+        case (QuirkProfile::CosmacVip):
+            return f.template operator()<Quirks<QuirkProfile::CosmacVip>>();
+        case (QuirkProfile::SuperChip):
+            return f.template operator()<Quirks<QuirkProfile::SuperChip>>();
+        case (QuirkProfile::XoChip):
+            return f.template operator()<Quirks<QuirkProfile::XoChip>>();
+        case (QuirkProfile::Chip8):
+            break;
+    }
+    return f.template operator()<Quirks<QuirkProfile::Chip8>>();
+}
+
+constexpr std::array<std::string_view, quirk_profile_count> quirk_profile_names{ "chip8", "vip", "schip", "xochip" };
+
+[[nodiscard]] constexpr std::string_view quirk_profile_name(QuirkProfile profile) noexcept {
+    return quirk_profile_names.at(static_cast<std::size_t>(profile));
+}
+
+[[nodiscard]] constexpr std::optional<QuirkProfile> parse_quirk_profile(std::string_view name) noexcept {
+    for (std::size_t i = 0; i < quirk_profile_count; ++i) {
+        if (quirk_profile_names.at(i) == name) {
+            return static_cast<QuirkProfile>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+#endif
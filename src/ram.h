@@ -2,6 +2,9 @@
 #define C8_RAM_H
 
 #include "common.h"
+#include "decoder.h"
+#include "opcode.h"
+#include "sprite.h"
 
 #include <gsl/gsl>
 
@@ -9,126 +12,55 @@
 #include <array>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <stdexcept>
+#include <tuple>
 #include <vector>
 
-enum class Operation : u8 {
-    ClearReturn = 0x0,
-    Jump = 0x1,
-    Call = 0x2,
-    IfRegNotEqualValue = 0x3,
-    IfRegEqualValue = 0x4,
-    IfRegNotEqualReg = 0x5,
-    SetRegValue = 0x6,
-    AddToReg = 0x7,
-    RegOperations = 0x8,
-    IfRegEquality = 0x9,
-    SetIndex = 0xa,
-    JumpV0Addr = 0xb,
-    RandomNumber = 0xc,
-    LoadSprite = 0xd,
-    KeyPress = 0xe,
-    Other = 0xf
-};
-
-enum class ClearReturn : u16 {
-    Clear = 0xe0,
-    Return = 0xee,
-};
-
-enum class RegOperation : u8 {
-    Set = 0x0,
-    BitwiseOr = 0x1,
-    BitwiseAnd = 0x2,
-    BitwiseXor = 0x3,
-    Addition = 0x4,
-    Subtraction = 0x5,
-    ShiftRight = 0x6,
-    AltSubtraction = 0x7,
-    ShiftLeft = 0xe,
-};
-
-enum class KeyPressOp : u16 {
-    IfKeyNotPressed = 0x9e,
-    IfKeyPressed = 0xa1,
-};
-
-enum class OtherOp : u16 {
-    SetVxDelay = 0x07,
-    SetVxKey = 0x0a,
-    SetDelay = 0x15,
-    SetBuzzer = 0x18,
-    AddVxToIndex = 0x1e,
-    SetIndexToHex = 0x29,
-    BcdVx = 0x33,
-    StoreToRam = 0x55,
-    LoadFromRam = 0x65,
-};
-
-class Opcode {
-  public:
-    explicit Opcode(u16 op);
-
-    Opcode &operator=(u16 op);
-
-    // get 4 bits starting from position pos.
-    // pos is from right to left starting from 0
-    [[nodiscard]] inline u8 get_nibble(u8 pos) const noexcept {
-        Expects(pos >= 0 && pos <= 3);
-        return m_opcode >> (pos * m_nibble) & m_nibble_mask;
-    }
+constexpr u8 bytes_per_ch = 5;
+constexpr u16 default_memory_size = 4096;
+constexpr u8 font_size = 80;
+constexpr u16 font_start = 0x50;
+constexpr u16 rom_start = 0x200;
 
-    // get the least significant byte (pos = 0) or
-    // most significant byte (pos = 1)
-    [[nodiscard]] inline u8 get_byte(u8 pos) const noexcept {
-        Expects(pos == 0 || pos == 1);
-        return m_opcode >> (pos * m_byte) & m_byte_mask;
-    }
+// the 8x10 SUPER-CHIP font FX30 points into, right after the small one
+constexpr u8 big_bytes_per_ch = 10;
+constexpr u8 big_font_size = 160;
+constexpr u16 big_font_start = font_start + font_size;
 
-    // get lower 12 bits
-    [[nodiscard]] inline u16 get_12bits() const noexcept {
-        return (static_cast<u16>(get_nibble(2)) << m_byte) | get_byte(0);
-    }
+// a DXY0 sprite, 16 rows of two bytes
+constexpr u8 large_sprite_size = 32;
 
-    // get operation type by checking most significant 4 bits
-    [[nodiscard]] inline Operation get_operation_type() const noexcept {
-        return static_cast<Operation>(get_nibble(3));
-    }
+[[nodiscard]] inline std::vector<u8> read_rom_file(const std::filesystem::path &filename) {
+    auto rom_file = std::ifstream{ filename, std::ios::binary | std::ios::in };
+    rom_file.exceptions(std::ifstream::failbit);
+    rom_file.exceptions(std::ifstream::goodbit);
 
-    void print() const noexcept;
+    std::vector<u8> rom(std::istreambuf_iterator(rom_file.rdbuf()), std::istreambuf_iterator<char>{});
+    rom_file.clear(std::ifstream::eofbit);
+    rom_file.exceptions(std::ifstream::failbit);
 
-  private:
-    u16 m_opcode;
+    return rom;
+}
 
-    static constexpr u8 m_nibble = 4;
-    static constexpr u8 m_nibble_mask = 0x0f;
-    static constexpr u8 m_byte = 8;
-    static constexpr u8 m_byte_mask = 0xff;
-};
-
-constexpr u8 bytes_per_ch = 5;
-constexpr u16 default_memory_size = 4096;
-constexpr u8 font_size = 80;
-constexpr u16 font_start = 0x50;
-constexpr u16 rom_start = 0x200;
+// called with the first and last address of every write into memory
+using WriteHook = void (*)(void *context, u16 first, u16 last);
 
 template <u16 N = default_memory_size>
 class RAM {
   public:
-    explicit RAM(const std::filesystem::path &filename) {
-        auto rom_file = std::ifstream{ filename, std::ios::binary | std::ios::in };
-        rom_file.exceptions(std::ifstream::failbit);
-        rom_file.exceptions(std::ifstream::goodbit);
+    explicit RAM(const std::filesystem::path &filename) : RAM(read_rom_file(filename)) {}
 
-        // load rom file to memory
-        auto rom_finish = std::copy(std::istreambuf_iterator(rom_file.rdbuf()), std::istreambuf_iterator<char>(), m_data.begin() + rom_start);
-        rom_file.clear(std::ifstream::eofbit);
-        rom_file.exceptions(std::ifstream::failbit);
+    explicit RAM(gsl::span<const u8> rom) : m_data{}, m_rom_size(rom.size()) {
+        if (rom.size() > N - rom_start) {
+            throw std::runtime_error("rom does not fit in memory");
+        }
 
-        // determine rom file's size
-        m_rom_size = std::distance(m_data.begin() + rom_start, rom_finish);
+        // load rom to memory
+        std::copy(rom.begin(), rom.end(), m_data.begin() + rom_start);
 
         // load default font
         constexpr std::array<u8, font_size> default_font{
@@ -150,6 +82,38 @@ class RAM {
             0xF0, 0x80, 0xF0, 0x80, 0x80  // F
         };
         std::copy(default_font.begin(), default_font.end(), m_data.begin() + font_start);
+
+        // SUPER-CHIP 1.1 only has the digits, the letters follow their style
+        constexpr std::array<u8, big_font_size> big_font{
+            0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, // 0
+            0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, // 1
+            0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // 2
+            0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 3
+            0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, // 4
+            0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 5
+            0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 6
+            0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18, // 7
+            0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 8
+            0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 9
+            0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+            0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, // B
+            0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C, // C
+            0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+            0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
+            0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  // F
+        };
+        std::copy(big_font.begin(), big_font.end(), m_data.begin() + big_font_start);
+    }
+
+    // decoded instruction at pc; decoding happens only on the first fetch
+    // after the bytes at pc were loaded or written
+    [[nodiscard]] inline const Instruction &fetch_decoded(u16 pc) noexcept {
+        Expects(pc >= 0 && pc + 1 < N);
+        auto &instruction = m_decoded[pc];
+        if (instruction.kind == Instr::NotDecoded) {
+            instruction = decode(fetch(pc));
+        }
+        return instruction;
     }
 
     [[nodiscard]] inline Opcode fetch(u16 pc) const noexcept {
@@ -158,14 +122,20 @@ class RAM {
         return Opcode{ (static_cast<u16>(m_data.at(pc)) << 8) | static_cast<u16>(m_data.at(pc + 1)) };
     }
 
-    [[nodiscard]] inline std::vector<u8> get_sprite(u16 i, u8 n) const noexcept {
-        Expects(i >= 0 && i < N);
-        Expects(i + n < N);
+    void set_write_hook(WriteHook hook, void *context) noexcept {
+        m_write_hook = hook;
+        m_write_hook_context = context;
+    }
 
-        std::vector<u8> vec;
-        vec.insert(vec.begin(), std::next(m_data.begin(), i), std::next(m_data.begin(), i + n));
+    // view of the n sprite rows at i, wrapping around the end of memory
+    [[nodiscard]] inline Sprite get_sprite(u16 i, u8 n) const noexcept {
+        Expects(i < N);
 
-        return vec;
+        auto memory = gsl::span<const u8>(m_data);
+        if (i + n <= N) {
+            return Sprite(memory.subspan(i, n));
+        }
+        return Sprite(memory.subspan(i), memory.first(i + n - N));
     }
 
     [[nodiscard]] inline u16 get_font_addr(u8 ch) const noexcept {
@@ -174,6 +144,12 @@ class RAM {
         return font_start + ch * bytes_per_ch;
     }
 
+    [[nodiscard]] inline u16 get_big_font_addr(u8 ch) const noexcept {
+        Expects(ch <= 0x0f);
+
+        return big_font_start + ch * big_bytes_per_ch;
+    }
+
     inline void store_bcd(u16 i, u8 vx) noexcept {
         Expects(i + 2 < N);
 
@@ -181,11 +157,13 @@ class RAM {
         m_data.at(i) = vx / (base10 * base10);
         m_data.at(i + 1) = (vx / base10) % base10;
         m_data.at(i + 2) = vx % base10;
+        invalidate(i, i + 2);
     }
 
     void store(u16 i, u8 vx, const gsl::span<u8> &&regs) noexcept {
         Expects(i + vx <= N);
         std::copy(gsl::begin(regs), std::next(gsl::begin(regs), vx + 1), std::next(m_data.begin(), i));
+        invalidate(i, i + vx);
     }
 
     void load(u16 i, u8 vx, gsl::span<u8> &&regs) noexcept {
@@ -193,6 +171,29 @@ class RAM {
         std::copy(std::next(m_data.begin(), i), std::next(m_data.begin(), i + vx + 1), gsl::begin(regs));
     }
 
+    [[nodiscard]] inline gsl::span<const u8> data() const noexcept {
+        return m_data;
+    }
+
+    // overwrite memory with data, only changed bytes are invalidated
+    void restore(gsl::span<const u8> data) noexcept {
+        Expects(data.size() == N);
+        auto dst = m_data.begin();
+        auto src = data.begin();
+        for (;;) {
+            std::tie(dst, src) = std::mismatch(dst, m_data.end(), src);
+            if (dst == m_data.end()) {
+                return;
+            }
+            auto first = static_cast<u16>(std::distance(m_data.begin(), dst));
+            auto [run_end, src_end] = std::mismatch(dst, m_data.end(), src, std::not_equal_to<>());
+            std::copy(src, src_end, dst);
+            invalidate(first, static_cast<u16>(std::distance(m_data.begin(), run_end) - 1));
+            dst = run_end;
+            src = src_end;
+        }
+    }
+
 #ifdef CH_DEBUG
     void print_rom() const {
         auto prev_fill = std::cout.fill('0');
@@ -227,8 +228,23 @@ class RAM {
 #endif
 
   private:
+    // drop decoded instructions overlapping the bytes first..last
+    inline void invalidate(u16 first, u16 last) noexcept {
+        auto begin = first > 0 ? first - 1 : 0;
+        auto end = std::min<std::size_t>(last + 1, N);
+        std::fill(std::next(m_decoded.begin(), begin), std::next(m_decoded.begin(), end), Instruction{});
+        if (m_write_hook != nullptr) {
+            m_write_hook(m_write_hook_context, first, last);
+        }
+    }
+
     std::array<u8, N> m_data;
     u16 m_rom_size;
+
+    std::array<Instruction, N> m_decoded;
+
+    WriteHook m_write_hook = nullptr;
+    void *m_write_hook_context = nullptr;
 };
 
 #endif
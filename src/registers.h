@@ -13,8 +13,11 @@ class Registers {
 
     Registers(u16 rom_start);
 
-    // update timer registers (timer and sound)
-    void update_timers(double dt);
+    // one 60 Hz tick of the timer registers (timer and sound)
+    inline void tick_timers() noexcept {
+        m_timer -= m_timer > 0 ? 1 : 0;
+        m_sound -= m_sound > 0 ? 1 : 0;
+    }
 
     // next instruction
     inline void incr_pc() {
@@ -40,11 +43,11 @@ class Registers {
         m_index = addr;
     }
 
-    inline void set_timer(const double time) {
+    inline void set_timer(const u8 time) {
         m_timer = time;
     }
 
-    inline void set_sound(const double sound) {
+    inline void set_sound(const u8 sound) {
         m_sound = sound;
     }
 
@@ -56,23 +59,37 @@ class Registers {
         return m_index;
     }
 
-    [[nodiscard]] inline double get_timer() const {
+    [[nodiscard]] inline u8 get_timer() const {
         return m_timer;
     }
 
+    [[nodiscard]] inline u8 get_sound() const {
+        return m_sound;
+    }
+
     gsl::span<u8> get_regs_span();
+    [[nodiscard]] gsl::span<const u8> get_regs_span() const;
 
     inline u8 &at(size_t i) {
         return m_regs.at(i);
     }
 
+    [[nodiscard]] inline u8 at(size_t i) const {
+        return m_regs.at(i);
+    }
+
   private:
     std::array<u8, m_number_of_registers> m_regs;
     u16 m_pc;    // program counter
     u16 m_index; // pointer to ram memory for sprites
 
-    double m_timer;
-    double m_sound;
+    u8 m_timer;
+    u8 m_sound;
 };
 
+// the HP48 RPL user flags SUPER-CHIP's FX75 and FX85 save registers into,
+// as many as there are registers like in XO-CHIP
+constexpr u8 rpl_flag_count = Registers::m_number_of_registers;
+using RplFlags = std::array<u8, rpl_flag_count>;
+
 #endif
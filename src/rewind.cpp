@@ -0,0 +1,128 @@
+#include "rewind.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+constexpr std::size_t max_run = std::numeric_limits<u16>::max();
+
+void put_u16(std::vector<u8> &out, std::size_t value) {
+    out.push_back(static_cast<u8>(value & 0xff));
+    out.push_back(static_cast<u8>(value >> 8));
+}
+
+std::size_t get_u16(const std::vector<u8> &in, std::size_t pos) {
+    return static_cast<std::size_t>(in[pos]) | static_cast<std::size_t>(in[pos + 1]) << 8;
+}
+
+// pairs of (zero run, literal run) lengths, each followed by its literal bytes
+void encode_delta(gsl::span<const u8> keyframe, gsl::span<const u8> frame, std::vector<u8> &out) {
+    std::size_t i = 0;
+    while (i < frame.size()) {
+        std::size_t zeros = 0;
+        while (i + zeros < frame.size() && zeros < max_run && (keyframe[i + zeros] ^ frame[i + zeros]) == 0) {
+            ++zeros;
+        }
+        i += zeros;
+
+        std::size_t literals = 0;
+        while (i + literals < frame.size() && literals < max_run && (keyframe[i + literals] ^ frame[i + literals]) != 0) {
+            ++literals;
+        }
+
+        put_u16(out, zeros);
+        put_u16(out, literals);
+        for (std::size_t j = 0; j < literals; ++j) {
+            out.push_back(keyframe[i + j] ^ frame[i + j]);
+        }
+        i += literals;
+    }
+}
+
+void apply_delta(const std::vector<u8> &delta, gsl::span<u8> frame) {
+    std::size_t pos = 0;
+    std::size_t i = 0;
+    while (pos < delta.size()) {
+        i += get_u16(delta, pos);
+        auto literals = get_u16(delta, pos + 2);
+        pos += 4;
+        for (std::size_t j = 0; j < literals; ++j) {
+            frame[i + j] ^= delta[pos + j];
+        }
+        i += literals;
+        pos += literals;
+    }
+}
+} // namespace
+
+RewindBuffer::RewindBuffer(std::size_t memory_cap, unsigned int keyframe_interval) : m_memory_cap(memory_cap), m_keyframe_interval(keyframe_interval), m_memory_used(0), m_since_keyframe(0) {
+    Expects(keyframe_interval > 0);
+}
+
+void RewindBuffer::record(const Snapshot &snapshot) {
+    auto bytes = snapshot_bytes(snapshot);
+
+    Entry entry;
+    if (m_entries.empty() || m_since_keyframe + 1 >= m_keyframe_interval) {
+        entry.is_keyframe = true;
+        entry.data.assign(bytes.begin(), bytes.end());
+        m_keyframe = entry.data;
+        m_since_keyframe = 0;
+    } else {
+        entry.is_keyframe = false;
+        encode_delta(m_keyframe, bytes, entry.data);
+        entry.data.shrink_to_fit();
+        ++m_since_keyframe;
+    }
+
+    m_memory_used += entry.data.size();
+    m_entries.push_back(std::move(entry));
+
+    // keep at least the newest keyframe and its deltas
+    while (m_memory_used > m_memory_cap && !m_entries.empty()) {
+        auto second = std::find_if(std::next(m_entries.begin()), m_entries.end(), [](const Entry &e) { return e.is_keyframe; });
+        if (second == m_entries.end()) {
+            break;
+        }
+        drop_oldest_keyframe();
+    }
+}
+
+bool RewindBuffer::rewind(unsigned int frames_back, Snapshot &snapshot) {
+    if (frames_back >= m_entries.size()) {
+        return false;
+    }
+
+    // forget the frames after the one restored
+    for (unsigned int i = 0; i < frames_back; ++i) {
+        m_memory_used -= m_entries.back().data.size();
+        m_entries.pop_back();
+    }
+
+    auto keyframe = std::find_if(m_entries.rbegin(), m_entries.rend(), [](const Entry &e) { return e.is_keyframe; });
+    Expects(keyframe != m_entries.rend());
+    m_keyframe = keyframe->data;
+    m_since_keyframe = static_cast<unsigned int>(std::distance(m_entries.rbegin(), keyframe));
+
+    auto *bytes = reinterpret_cast<u8 *>(&snapshot);
+    std::memcpy(bytes, m_keyframe.data(), sizeof(Snapshot));
+    if (!m_entries.back().is_keyframe) {
+        apply_delta(m_entries.back().data, gsl::span<u8>(bytes, sizeof(Snapshot)));
+    }
+    return true;
+}
+
+void RewindBuffer::clear() noexcept {
+    m_entries.clear();
+    m_keyframe.clear();
+    m_memory_used = 0;
+    m_since_keyframe = 0;
+}
+
+void RewindBuffer::drop_oldest_keyframe() noexcept {
+    do {
+        m_memory_used -= m_entries.front().data.size();
+        m_entries.pop_front();
+    } while (!m_entries.empty() && !m_entries.front().is_keyframe);
+}
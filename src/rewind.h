@@ -0,0 +1,59 @@
+#ifndef C8_REWIND_H
+#define C8_REWIND_H
+
+#include "common.h"
+#include "snapshot.h"
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// ring of snapshots, one per frame. Every keyframe_interval frames a full
+// snapshot is kept, the frames in between are stored as the xor against that
+// keyframe with runs of zero bytes collapsed, so restoring any frame needs
+// one keyframe and one delta. The oldest keyframe and its deltas are dropped
+// whenever the buffer grows past its memory cap
+class RewindBuffer {
+  public:
+    static constexpr std::size_t default_memory_cap = 8 * 1024 * 1024;
+    static constexpr unsigned int default_keyframe_interval = 60;
+
+    explicit RewindBuffer(std::size_t memory_cap = default_memory_cap, unsigned int keyframe_interval = default_keyframe_interval);
+
+    void record(const Snapshot &snapshot);
+
+    // restore the state recorded frames_back frames before the newest one and
+    // forget everything newer. False when not that many frames are stored
+    [[nodiscard]] bool rewind(unsigned int frames_back, Snapshot &snapshot);
+
+    void clear() noexcept;
+
+    // frames that can be restored
+    [[nodiscard]] inline std::size_t size() const noexcept {
+        return m_entries.size();
+    }
+
+    [[nodiscard]] inline std::size_t memory_used() const noexcept {
+        return m_memory_used;
+    }
+
+  private:
+    struct Entry {
+        bool is_keyframe;
+        std::vector<u8> data; // the snapshot, or its delta to the keyframe
+    };
+
+    void drop_oldest_keyframe() noexcept;
+
+    std::size_t m_memory_cap;
+    unsigned int m_keyframe_interval;
+
+    std::deque<Entry> m_entries;
+    std::size_t m_memory_used;
+
+    // newest keyframe, deltas are taken against it
+    std::vector<u8> m_keyframe;
+    unsigned int m_since_keyframe;
+};
+
+#endif
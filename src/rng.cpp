@@ -0,0 +1,8 @@
+#include "rng.h"
+
+#include <random>
+
+Rng::Rng() : Rng(std::random_device{}()) {}
+
+// xorshift never leaves the all zero state
+Rng::Rng(u32 seed) noexcept : m_state(seed != 0 ? seed : 1) {}
@@ -0,0 +1,29 @@
+#ifndef C8_RNG_H
+#define C8_RNG_H
+
+#include "common.h"
+
+#include <limits>
+
+// xorshift32, small and trivially copyable so it is saved with the machine
+class Rng {
+  public:
+    Rng(); // seeded from std::random_device
+    explicit Rng(u32 seed) noexcept;
+
+    inline unsigned int gen() noexcept {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state & std::numeric_limits<u8>::max();
+    }
+
+    [[nodiscard]] inline u32 state() const noexcept {
+        return m_state;
+    }
+
+  private:
+    u32 m_state;
+}; // for random number generation
+
+#endif
@@ -0,0 +1,241 @@
+#include "rom_db.h"
+
+#include "quirks.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace {
+// a positive count with nothing after it, from_chars also turns down signs
+std::optional<unsigned int> parse_instr_per_frame(std::string_view text) noexcept {
+    unsigned int value = 0;
+    const auto *end = text.data() + text.size();
+    auto [parsed, error] = std::from_chars(text.data(), end, value);
+    if (error != std::errc() || parsed != end || value == 0) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+struct RomEntry {
+    Sha1 digest;
+    RomInfo info;
+};
+
+constexpr std::array builtin_roms{
+    // IBM_Logo.ch8, the COSMAC VIP demo
+    RomEntry{ parse_sha1("1ba58656810b67fd131eb9af3e3987863bf26c90"), { QuirkProfile::CosmacVip, 0, Variant::Chip8 } },
+    // test_opcode.ch8 by corax89
+    RomEntry{ parse_sha1("f1cfcffe1937ed6dd6eeed1a7f85dfc777bda700"), { QuirkProfile::Chip8, 0, Variant::Chip8 } },
+};
+
+// the digest is already uniform, its first bytes make a good key
+constexpr u64 key_of(const Sha1 &digest) noexcept {
+    u64 key = 0;
+    for (std::size_t i = 0; i < sizeof(u64); ++i) {
+        key = key << 8 | digest.at(i);
+    }
+    return key;
+}
+
+// at most half full, so a seed without collisions is found quickly
+constexpr unsigned int table_bits = std::max<unsigned int>(1, std::bit_width(2 * builtin_roms.size() - 1));
+constexpr std::size_t table_size = std::size_t{ 1 } << table_bits;
+
+constexpr std::size_t slot_of(u64 key, u64 seed) noexcept {
+    constexpr u64 golden_ratio = 0x9e3779b97f4a7c15;
+    return static_cast<std::size_t>(((key ^ seed) * golden_ratio) >> (64 - table_bits));
+}
+
+// slots hold the index of their entry plus one, 0 for an empty slot
+struct PerfectHash {
+    u64 seed = 0;
+    std::array<u8, table_size> slots{};
+};
+
+consteval PerfectHash make_perfect_hash() {
+    static_assert(builtin_roms.size() < std::numeric_limits<u8>::max());
+    for (u64 seed = 0;; ++seed) {
+        PerfectHash table{ seed, {} };
+        bool collided = false;
+        for (std::size_t i = 0; i < builtin_roms.size() && !collided; ++i) {
+            auto &slot = table.slots.at(slot_of(key_of(builtin_roms.at(i).digest), seed));
+            collided = slot != 0;
+            slot = static_cast<u8>(i + 1);
+        }
+        if (!collided) {
+            return table;
+        }
+    }
+}
+
+constexpr PerfectHash builtin_table = make_perfect_hash();
+
+constexpr std::array<std::string_view, 3> variant_names{ "chip8", "schip", "xochip" };
+
+std::optional<Variant> parse_variant(std::string_view name) noexcept {
+    for (std::size_t i = 0; i < variant_names.size(); ++i) {
+        if (variant_names.at(i) == name) {
+            return static_cast<Variant>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+// SHA-1 as in FIPS 180-4, over 64 byte blocks
+class Sha1Hasher {
+  public:
+    void update(gsl::span<const u8> bytes) noexcept {
+        for (auto byte : bytes) {
+            m_block.at(m_used++) = byte;
+            if (m_used == m_block.size()) {
+                compress();
+                m_used = 0;
+            }
+        }
+        m_length += bytes.size();
+    }
+
+    Sha1 finish() noexcept {
+        u64 bits = m_length * 8;
+        constexpr std::array<u8, 1> marker{ 0x80 };
+        constexpr std::array<u8, 1> zero{ 0x00 };
+        update(marker);
+        while (m_used != m_block.size() - sizeof(u64)) {
+            update(zero);
+        }
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            update(std::array<u8, 1>{ static_cast<u8>(bits >> shift) });
+        }
+
+        Sha1 digest{};
+        for (std::size_t i = 0; i < digest.size(); ++i) {
+            digest.at(i) = static_cast<u8>(m_state.at(i / 4) >> (24 - 8 * (i % 4)));
+        }
+        return digest;
+    }
+
+  private:
+    void compress() noexcept {
+        std::array<u32, 80> w{};
+        for (std::size_t i = 0; i < 16; ++i) {
+            w.at(i) = static_cast<u32>(m_block.at(4 * i)) << 24 | static_cast<u32>(m_block.at(4 * i + 1)) << 16 | static_cast<u32>(m_block.at(4 * i + 2)) << 8 | m_block.at(4 * i + 3);
+        }
+        for (std::size_t i = 16; i < w.size(); ++i) {
+            w.at(i) = std::rotl(w.at(i - 3) ^ w.at(i - 8) ^ w.at(i - 14) ^ w.at(i - 16), 1);
+        }
+
+        auto [a, b, c, d, e] = m_state;
+        for (std::size_t i = 0; i < w.size(); ++i) {
+            u32 f = 0;
+            u32 k = 0;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            u32 temp = std::rotl(a, 5) + f + e + k + w.at(i);
+            e = d;
+            d = c;
+            c = std::rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        m_state.at(0) += a;
+        m_state.at(1) += b;
+        m_state.at(2) += c;
+        m_state.at(3) += d;
+        m_state.at(4) += e;
+    }
+
+    std::array<u32, 5> m_state{ 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+    std::array<u8, 64> m_block{};
+    std::size_t m_used = 0;
+    u64 m_length = 0;
+};
+} // namespace
+
+Sha1 sha1(gsl::span<const u8> bytes) noexcept {
+    Sha1Hasher hasher;
+    hasher.update(bytes);
+    return hasher.finish();
+}
+
+std::optional<RomInfo> builtin_rom_info(const Sha1 &digest) noexcept {
+    auto slot = builtin_table.slots.at(slot_of(key_of(digest), builtin_table.seed));
+    if (slot == 0 || builtin_roms.at(slot - 1).digest != digest) {
+        return std::nullopt;
+    }
+    return builtin_roms.at(slot - 1).info;
+}
+
+void RomDatabase::load_overrides(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open rom database " + path.string());
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // a comment runs from '#' to the end of the line
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string digest;
+        std::string quirks;
+        std::string speed;
+        std::string variant = "chip8";
+        std::string rest;
+        RomInfo info;
+        if (!(fields >> digest)) {
+            continue; // blank or only a comment
+        }
+        if (!(fields >> quirks)) {
+            throw std::runtime_error("bad rom database line: " + line);
+        }
+        if (fields >> speed) {
+            auto instr_per_frame = parse_instr_per_frame(speed);
+            if (!instr_per_frame) {
+                throw std::runtime_error("bad rom database line: " + line);
+            }
+            info.instr_per_frame = *instr_per_frame;
+            fields >> variant;
+        }
+        if (fields >> rest) {
+            throw std::runtime_error("bad rom database line: " + line);
+        }
+
+        auto profile = parse_quirk_profile(quirks);
+        auto parsed_variant = parse_variant(variant);
+        if (!profile || !parsed_variant) {
+            throw std::runtime_error("bad rom database line: " + line);
+        }
+        info.quirks = *profile;
+        info.variant = *parsed_variant;
+        try {
+            m_overrides[parse_sha1(digest)] = info;
+        } catch (std::invalid_argument &) {
+            throw std::runtime_error("bad rom database line: " + line);
+        }
+    }
+}
+
+std::optional<RomInfo> RomDatabase::find(const Sha1 &digest) const noexcept {
+    auto entry = m_overrides.find(digest);
+    if (entry != m_overrides.end()) {
+        return entry->second;
+    }
+    return builtin_rom_info(digest);
+}
@@ -0,0 +1,91 @@
+#ifndef C8_ROM_DB_H
+#define C8_ROM_DB_H
+
+#include "common.h"
+
+#include <chip8/chip8.h>
+
+#include <gsl/gsl>
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+using Sha1 = std::array<u8, 20>;
+
+[[nodiscard]] Sha1 sha1(gsl::span<const u8> bytes) noexcept;
+
+// instruction set a rom needs, on top of the quirks it expects
+enum class Variant : u8 {
+    Chip8,
+    SuperChip,
+    XoChip,
+};
+
+// how a known rom wants to be run
+struct RomInfo {
+    QuirkProfile quirks = QuirkProfile::Chip8;
+    unsigned int instr_per_frame = 0; // 0 keeps the default speed
+    Variant variant = Variant::Chip8;
+};
+
+// digest of the 40 hex digits sha1sum prints
+[[nodiscard]] constexpr Sha1 parse_sha1(std::string_view hex) {
+    constexpr int base16 = 16;
+    auto digit = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    };
+
+    Sha1 digest{};
+    if (hex.size() != digest.size() * 2) {
+        throw std::invalid_argument("a sha1 has 40 hex digits");
+    }
+    for (std::size_t i = 0; i < digest.size(); ++i) {
+        auto high = digit(hex[2 * i]);
+        auto low = digit(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            throw std::invalid_argument("a sha1 has 40 hex digits");
+        }
+        digest.at(i) = static_cast<u8>(high * base16 + low);
+    }
+    return digest;
+}
+
+// the roms this build knows, looked up in a perfect hash table computed by
+// the compiler: one probe and one digest compare, nothing built at startup
+[[nodiscard]] std::optional<RomInfo> builtin_rom_info(const Sha1 &digest) noexcept;
+
+// the built-in roms with entries of override files layered on top. Override
+// lines are "sha1 quirks [instr_per_frame [variant]]" with quirks one of
+// chip8, vip, schip or xochip, instr_per_frame a positive count, variant one
+// of chip8, schip or xochip, and '#' starting a comment that runs to the end
+// of the line. Blank lines are skipped and later entries win over earlier ones
+class RomDatabase {
+  public:
+    // throws std::runtime_error if path cannot be read or has a bad line
+    void load_overrides(const std::filesystem::path &path);
+
+    [[nodiscard]] std::optional<RomInfo> find(const Sha1 &digest) const noexcept;
+
+    [[nodiscard]] inline std::optional<RomInfo> find(gsl::span<const u8> rom) const noexcept {
+        return find(sha1(rom));
+    }
+
+  private:
+    std::map<Sha1, RomInfo> m_overrides;
+};
+
+#endif
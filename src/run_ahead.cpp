@@ -0,0 +1,16 @@
+#include "run_ahead.h"
+
+RunAhead::RunAhead(unsigned int frames) : m_frames(frames), m_snapshot(std::make_unique<Snapshot>()) {}
+
+void RunAhead::run_frame(CPU &cpu, Frontend &frontend) {
+    cpu.step_frame();
+    cpu.save(*m_snapshot);
+
+    // speculative frames are never presented, only their result
+    for (unsigned int frame = 0; frame < m_frames && !cpu.is_trapped(); ++frame) {
+        cpu.step_frame();
+    }
+    frontend.present(cpu.framebuffer());
+
+    cpu.load(*m_snapshot);
+}
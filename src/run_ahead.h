@@ -0,0 +1,32 @@
+#ifndef C8_RUN_AHEAD_H
+#define C8_RUN_AHEAD_H
+
+#include "common.h"
+#include "cpu.h"
+#include "frontend.h"
+#include "snapshot.h"
+
+#include <memory>
+
+// hides the frames a rom takes to react to input: every frame runs for real,
+// is saved, then frames more are run with the same input only to present the
+// screen they end on, and the saved state is restored
+class RunAhead {
+  public:
+    explicit RunAhead(unsigned int frames);
+
+    // one host frame in place of cpu.run_frame(), frontend is the one cpu
+    // reads its input from. It is not polled, poll it before every frame
+    void run_frame(CPU &cpu, Frontend &frontend);
+
+    // state after the last real frame
+    [[nodiscard]] inline const Snapshot &snapshot() const noexcept {
+        return *m_snapshot;
+    }
+
+  private:
+    unsigned int m_frames;
+    std::unique_ptr<Snapshot> m_snapshot;
+};
+
+#endif
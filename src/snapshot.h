@@ -0,0 +1,67 @@
+#ifndef C8_SNAPSHOT_H
+#define C8_SNAPSHOT_H
+
+#include "call_stack.h"
+#include "common.h"
+#include "framebuffer.h"
+#include "quirks.h"
+#include "ram.h"
+#include "registers.h"
+#include "rng.h"
+
+#include <gsl/gsl>
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+constexpr u32 snapshot_magic = 0x53384843; // "CH8S" in little endian
+constexpr u16 snapshot_version = 4;
+
+// complete machine state in one fixed layout block, saved and restored with
+// plain copies. The header guards against blobs of another version or build
+struct Snapshot {
+    u32 magic = snapshot_magic;
+    u16 version = snapshot_version;
+    u32 size = 0;
+
+    // the machine runs the same program differently under other quirks
+    QuirkProfile quirks = QuirkProfile::Chip8;
+    std::array<u8, default_memory_size> memory{};
+    Registers regs{ rom_start };
+    RplFlags flags{};
+    CallStack<> stack;
+    Framebuffer framebuffer;
+    Rng rng{ 1 };
+    CpuTrap trap;
+    i8 key_pressed = -1;
+    bool display_wait = false;
+
+    u32 instr_per_sec = 0;
+    u32 tick_phase = 0;
+    u32 frame_phase = 0;
+    double time_passed = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<Snapshot>, "snapshots are copied as bytes");
+
+[[nodiscard]] inline bool is_compatible(const Snapshot &snapshot) noexcept {
+    return snapshot.magic == snapshot_magic && snapshot.version == snapshot_version && snapshot.size == sizeof(Snapshot);
+}
+
+[[nodiscard]] inline gsl::span<const u8> snapshot_bytes(const Snapshot &snapshot) noexcept {
+    return { reinterpret_cast<const u8 *>(&snapshot), sizeof(Snapshot) };
+}
+
+inline void snapshot_from_bytes(gsl::span<const u8> bytes, Snapshot &snapshot) {
+    if (bytes.size() != sizeof(Snapshot)) {
+        throw std::runtime_error("snapshot has the wrong size");
+    }
+    std::memcpy(&snapshot, bytes.data(), sizeof(Snapshot));
+    if (!is_compatible(snapshot)) {
+        throw std::runtime_error("snapshot was saved by another version");
+    }
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef C8_SPRITE_H
+#define C8_SPRITE_H
+
+#include "common.h"
+
+#include <gsl/gsl>
+
+#include <cstddef>
+
+// non-owning view of the rows of a sprite. A sprite that runs past the end
+// of memory continues at address 0, so the view is made of two spans
+class Sprite {
+  public:
+    explicit Sprite(gsl::span<const u8> head, gsl::span<const u8> tail = {}) noexcept : m_head(head), m_tail(tail) {}
+
+    [[nodiscard]] inline std::size_t size() const noexcept {
+        return m_head.size() + m_tail.size();
+    }
+
+    [[nodiscard]] inline u8 operator[](std::size_t row) const noexcept {
+        return row < m_head.size() ? m_head[row] : m_tail[row - m_head.size()];
+    }
+
+  private:
+    gsl::span<const u8> m_head;
+    gsl::span<const u8> m_tail;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <null_frontend.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::size_t> allocations{ 0 };
+} // namespace
+
+// count every heap allocation made by this test executable
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, [[maybe_unused]] std::size_t size) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+std::size_t allocations_while_running(const char *rom, Dispatch dispatch) {
+    constexpr int instructions = 20000;
+    constexpr double one_second = 1.0;
+
+    NullFrontend frontend;
+    CPU cpu(rom, frontend, dispatch);
+
+    auto before = allocations.load();
+    cpu.run(instructions);
+    for (int frame = 0; frame < 60; ++frame) {
+        cpu.instr_cycle(one_second / 60);
+    }
+    return allocations.load() - before;
+}
+} // namespace
+
+TEST(AllocationTests, SwitchDispatchRunsWithoutAllocating) {
+    EXPECT_EQ(allocations_while_running("roms/IBM_Logo.ch8", Dispatch::Switch), 0);
+    EXPECT_EQ(allocations_while_running("roms/test_opcode.ch8", Dispatch::Switch), 0);
+}
+
+TEST(AllocationTests, ThreadedDispatchRunsWithoutAllocating) {
+    EXPECT_EQ(allocations_while_running("roms/IBM_Logo.ch8", Dispatch::Threaded), 0);
+    EXPECT_EQ(allocations_while_running("roms/test_opcode.ch8", Dispatch::Threaded), 0);
+}
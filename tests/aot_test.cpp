@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <aot.h>
+#include <cpu.h>
+#include <null_frontend.h>
+
+TEST(AotTests, MatchesInterpreter) {
+    constexpr int test_opcode_instructions = 2000;
+
+    NullFrontend interpreted_frontend;
+    CPU interpreted(translated_rom(), interpreted_frontend, Dispatch::Switch, translated_quirks());
+    interpreted.run(test_opcode_instructions);
+
+    NullFrontend translated_frontend;
+    CPU translated(translated_rom(), translated_frontend, translated_program, translated_quirks());
+    translated.run(test_opcode_instructions);
+
+    for (u8 y = 0; y < chip8_height; ++y) {
+        for (u8 x = 0; x < chip8_width; ++x) {
+            EXPECT_EQ(interpreted.framebuffer().is_set(x, y), translated.framebuffer().is_set(x, y));
+        }
+    }
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        EXPECT_EQ(interpreted.registers().at(reg), translated.registers().at(reg));
+    }
+    EXPECT_EQ(interpreted.registers().get_pc(), translated.registers().get_pc());
+    EXPECT_EQ(interpreted.registers().get_index(), translated.registers().get_index());
+}
+
+TEST(AotTests, StopsAtBudget) {
+    constexpr unsigned int max_budget = 64;
+
+    for (unsigned int budget = 1; budget <= max_budget; ++budget) {
+        NullFrontend interpreted_frontend;
+        CPU interpreted(translated_rom(), interpreted_frontend, Dispatch::Switch, translated_quirks());
+        interpreted.run(budget);
+
+        NullFrontend translated_frontend;
+        CPU translated(translated_rom(), translated_frontend, translated_program, translated_quirks());
+        translated.run(budget);
+
+        EXPECT_EQ(interpreted.registers().get_pc(), translated.registers().get_pc());
+    }
+}
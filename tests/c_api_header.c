@@ -0,0 +1,13 @@
+/* the C interface has to compile as C */
+#include <chip8/chip8_c.h>
+
+unsigned int c_api_run_frames(const uint8_t *rom, size_t rom_size, unsigned int frames) {
+    chip8_machine *machine = NULL;
+    unsigned int executed = 0;
+    if (chip8_create(rom, rom_size, 10, &machine) != CHIP8_OK) {
+        return 0;
+    }
+    executed = chip8_run_frames(machine, frames);
+    chip8_destroy(machine);
+    return executed;
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <chip8/chip8_c.h>
+#include <snapshot.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+extern "C" unsigned int c_api_run_frames(const uint8_t *rom, size_t rom_size, unsigned int frames);
+
+namespace {
+// draws digit 0 at (0, 0), then counts up V3 forever
+constexpr std::array<std::uint8_t, 10> draw_rom{
+    0x60, 0x00, // 200: V0 = 0
+    0xf0, 0x29, // 202: I = digit V0
+    0xd0, 0x05, // 204: draw at V0, V0
+    0x73, 0x01, // 206: V3 += 1
+    0x12, 0x06, // 208: jump 206
+};
+
+struct Destroy {
+    void operator()(chip8_machine *machine) const noexcept {
+        chip8_destroy(machine);
+    }
+};
+using MachinePtr = std::unique_ptr<chip8_machine, Destroy>;
+
+MachinePtr create(unsigned int instr_per_frame = 10) {
+    chip8_machine *machine = nullptr;
+    EXPECT_EQ(chip8_create(draw_rom.data(), draw_rom.size(), instr_per_frame, &machine), CHIP8_OK);
+    return MachinePtr(machine);
+}
+} // namespace
+
+TEST(CApiTests, ReportsItsVersion) {
+    EXPECT_EQ(chip8_abi_version(), CHIP8_ABI_VERSION);
+}
+
+TEST(CApiTests, RunsAndDraws) {
+    auto machine = create();
+    unsigned int width = 0;
+    unsigned int height = 0;
+    const auto *framebuffer = chip8_framebuffer(machine.get(), &width, &height);
+    ASSERT_NE(framebuffer, nullptr);
+    EXPECT_EQ(width, 64);
+    EXPECT_EQ(height, 32);
+
+    EXPECT_EQ(chip8_step(machine.get(), 3), 3);
+    EXPECT_EQ(chip8_run_frames(machine.get(), 2), 20);
+    // digit 0 starts with the row 0xf0
+    EXPECT_EQ(framebuffer[0] >> 56, 0xf0);
+    EXPECT_EQ(chip8_is_trapped(machine.get()), 0);
+
+    EXPECT_EQ(c_api_run_frames(draw_rom.data(), draw_rom.size(), 5), 50);
+}
+
+TEST(CApiTests, RejectsBadArguments) {
+    chip8_machine *machine = nullptr;
+    std::vector<std::uint8_t> too_large(4096, 0);
+    EXPECT_EQ(chip8_create(too_large.data(), too_large.size(), 0, &machine), CHIP8_ROM_TOO_LARGE);
+    EXPECT_EQ(machine, nullptr);
+    EXPECT_EQ(chip8_create(nullptr, 2, 0, &machine), CHIP8_INVALID_ARGUMENT);
+    EXPECT_EQ(chip8_create(draw_rom.data(), draw_rom.size(), 0, nullptr), CHIP8_INVALID_ARGUMENT);
+}
+
+TEST(CApiTests, SavesAndLoadsState) {
+    auto machine = create();
+    chip8_run_frames(machine.get(), 3);
+
+    std::vector<std::uint8_t> state(chip8_state_size() + 1);
+    EXPECT_EQ(chip8_save_state(machine.get(), state.data(), 16), CHIP8_BUFFER_TOO_SMALL);
+    // buffers need no particular alignment
+    ASSERT_EQ(chip8_save_state(machine.get(), state.data() + 1, chip8_state_size()), CHIP8_OK);
+
+    auto other = create();
+    ASSERT_EQ(chip8_load_state(other.get(), state.data() + 1, chip8_state_size()), CHIP8_OK);
+    chip8_run_frames(machine.get(), 4);
+    chip8_run_frames(other.get(), 4);
+
+    std::vector<std::uint8_t> expected(chip8_state_size());
+    std::vector<std::uint8_t> actual(chip8_state_size());
+    ASSERT_EQ(chip8_save_state(machine.get(), expected.data(), expected.size()), CHIP8_OK);
+    ASSERT_EQ(chip8_save_state(other.get(), actual.data(), actual.size()), CHIP8_OK);
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(chip8_framebuffer(machine.get(), nullptr, nullptr)[0], chip8_framebuffer(other.get(), nullptr, nullptr)[0]);
+
+    state.assign(state.size(), 0);
+    EXPECT_EQ(chip8_load_state(other.get(), state.data(), chip8_state_size()), CHIP8_INCOMPATIBLE_STATE);
+}
+
+TEST(CApiTests, RejectsCorruptedState) {
+    auto machine = create();
+    chip8_run_frames(machine.get(), 3);
+    std::vector<std::uint8_t> state(chip8_state_size());
+    ASSERT_EQ(chip8_save_state(machine.get(), state.data(), state.size()), CHIP8_OK);
+
+    // a stack pointer past the end of the stack and a machine that never runs
+    auto snapshot = std::make_unique<Snapshot>();
+    std::memcpy(snapshot.get(), state.data(), state.size());
+    std::uint8_t sp = 200;
+    std::memcpy(reinterpret_cast<std::uint8_t *>(&snapshot->stack) + sizeof(std::uint16_t) * chip8_stack_depth, &sp, sizeof(sp));
+    std::vector<std::uint8_t> corrupted(state.size());
+    std::memcpy(corrupted.data(), snapshot.get(), corrupted.size());
+    EXPECT_EQ(chip8_load_state(machine.get(), corrupted.data(), corrupted.size()), CHIP8_INCOMPATIBLE_STATE);
+
+    std::memcpy(snapshot.get(), state.data(), state.size());
+    snapshot->instr_per_sec = 0;
+    std::memcpy(corrupted.data(), snapshot.get(), corrupted.size());
+    EXPECT_EQ(chip8_load_state(machine.get(), corrupted.data(), corrupted.size()), CHIP8_INCOMPATIBLE_STATE);
+
+    // the machine kept its own state and still runs
+    EXPECT_GT(chip8_run_frames(machine.get(), 1), 0U);
+}
+
+TEST(CApiTests, CreatesWithQuirks) {
+    chip8_machine *raw = nullptr;
+    ASSERT_EQ(chip8_create_with_quirks(draw_rom.data(), draw_rom.size(), 10, CHIP8_QUIRKS_COSMAC_VIP, &raw), CHIP8_OK);
+    MachinePtr machine(raw);
+    // the draw waits for the next frame
+    EXPECT_EQ(chip8_step(machine.get(), 5), 3);
+
+    EXPECT_EQ(chip8_create_with_quirks(draw_rom.data(), draw_rom.size(), 10, static_cast<chip8_quirks>(4), &raw), CHIP8_INVALID_ARGUMENT);
+
+    // a state saved under other quirks does not load
+    std::vector<std::uint8_t> state(chip8_state_size());
+    ASSERT_EQ(chip8_save_state(machine.get(), state.data(), state.size()), CHIP8_OK);
+    auto chip8 = create();
+    EXPECT_EQ(chip8_load_state(chip8.get(), state.data(), state.size()), CHIP8_INCOMPATIBLE_STATE);
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <null_frontend.h>
+
+#include <array>
+
+static constexpr int ibm_logo_instructions = 20;
+
+static int count_set_pixels(const Framebuffer &framebuffer) {
+    int count = 0;
+    for (u8 y = 0; y < chip8_height; ++y) {
+        for (u8 x = 0; x < chip8_width; ++x) {
+            count += framebuffer.is_set(x, y) ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+TEST(CpuTests, RunsHeadless) {
+    NullFrontend frontend;
+    CPU cpu("roms/IBM_Logo.ch8", frontend);
+
+    for (int i = 0; i < ibm_logo_instructions; ++i) {
+        cpu.step();
+    }
+
+    EXPECT_EQ(frontend.presented_frames(), 0);
+    EXPECT_GT(count_set_pixels(cpu.framebuffer()), 0);
+}
+
+TEST(CpuTests, InstrCyclePresentsToFrontend) {
+    NullFrontend frontend;
+    CPU cpu("roms/IBM_Logo.ch8", frontend);
+
+    constexpr double one_instruction = 1.0 / 500;
+    cpu.instr_cycle(one_instruction);
+
+    EXPECT_EQ(frontend.presented_frames(), 1);
+}
+
+TEST(CpuTests, InstrCycleCatchesUpOnElapsedTime) {
+    NullFrontend frontend;
+    CPU cpu("roms/IBM_Logo.ch8", frontend);
+
+    constexpr double ten_and_a_half_instructions = 10.5 * sec_per_instr;
+    auto report = cpu.instr_cycle(ten_and_a_half_instructions);
+
+    EXPECT_EQ(report.executed, 10);
+    EXPECT_EQ(report.dropped, 0);
+    EXPECT_EQ(frontend.presented_frames(), 1);
+}
+
+TEST(CpuTests, InstrCycleDropsTimeBeyondCatchUp) {
+    NullFrontend frontend;
+    CPU cpu("roms/IBM_Logo.ch8", frontend);
+
+    constexpr double one_second = 1.0;
+    auto report = cpu.instr_cycle(one_second);
+
+    EXPECT_EQ(report.executed, static_cast<unsigned int>(max_catch_up * instr_per_sec));
+    EXPECT_DOUBLE_EQ(report.dropped, one_second - max_catch_up);
+    EXPECT_DOUBLE_EQ(cpu.dropped_time(), one_second - max_catch_up);
+    EXPECT_EQ(frontend.presented_frames(), 1);
+}
+
+TEST(CpuTests, InstrCycleReportsOnlyExecutedInstructions) {
+    const std::array<u8, 4> rom{
+        0x60, 0x01, // 200: V0 = 1
+        0x00, 0xfd, // 202: exit
+    };
+    NullFrontend frontend;
+    CPU cpu(rom, frontend);
+
+    auto report = cpu.instr_cycle(10 * sec_per_instr);
+    EXPECT_EQ(report.executed, 1);
+    EXPECT_EQ(cpu.trap().kind, Trap::Exit);
+}
+
+TEST(CpuTests, DispatchEnginesAgree) {
+    constexpr int test_opcode_instructions = 2000;
+
+    NullFrontend switch_frontend;
+    CPU switch_cpu("roms/test_opcode.ch8", switch_frontend, Dispatch::Switch);
+    switch_cpu.run(test_opcode_instructions);
+
+    NullFrontend threaded_frontend;
+    CPU threaded_cpu("roms/test_opcode.ch8", threaded_frontend, Dispatch::Threaded);
+    threaded_cpu.run(test_opcode_instructions);
+
+    for (u8 y = 0; y < chip8_height; ++y) {
+        for (u8 x = 0; x < chip8_width; ++x) {
+            EXPECT_EQ(switch_cpu.framebuffer().is_set(x, y), threaded_cpu.framebuffer().is_set(x, y));
+        }
+    }
+    EXPECT_GT(count_set_pixels(threaded_cpu.framebuffer()), 0);
+}
+
+TEST(CpuTests, RecursionTrapsOnStackOverflow) {
+    constexpr std::array<u8, 2> recursion{ 0x22, 0x00 }; // 200: call 200
+    for (auto dispatch : { Dispatch::Switch, Dispatch::Threaded }) {
+        NullFrontend frontend;
+        CPU cpu(recursion, frontend, dispatch);
+        cpu.run(100);
+
+        EXPECT_TRUE(cpu.is_trapped());
+        EXPECT_EQ(cpu.trap().kind, Trap::StackOverflow);
+        EXPECT_EQ(cpu.trap().pc, 0x200);
+        EXPECT_EQ(cpu.registers().get_pc(), 0x200);
+        EXPECT_EQ(cpu.stack().sp(), chip8_stack_depth);
+    }
+}
+
+TEST(CpuTests, ReturnWithoutCallTrapsOnStackUnderflow) {
+    constexpr std::array<u8, 4> stray_return{ 0x60, 0x01, 0x00, 0xee }; // 200: V0 = 1, 202: return
+    for (auto dispatch : { Dispatch::Switch, Dispatch::Threaded }) {
+        NullFrontend frontend;
+        CPU cpu(stray_return, frontend, dispatch);
+        cpu.run(10);
+
+        EXPECT_EQ(cpu.trap().kind, Trap::StackUnderflow);
+        EXPECT_EQ(cpu.trap().pc, 0x202);
+        EXPECT_EQ(cpu.registers().at(0), 1);
+    }
+}
+
+TEST(CpuTests, TimersTickFromInstructionCount) {
+    constexpr std::array<u8, 8> delay_loop{
+        0x60, 0x3c, // 200: V0 = 60
+        0xf0, 0x15, // 202: delay = V0
+        0xf1, 0x07, // 204: V1 = delay
+        0x12, 0x04, // 206: jump 204
+    };
+    constexpr unsigned int instructions = 252;
+    constexpr unsigned int expected_ticks = instructions * timer_hz / instr_per_sec;
+
+    NullFrontend frontend;
+    CPU whole(delay_loop, frontend);
+    whole.run(instructions);
+    EXPECT_EQ(whole.registers().get_timer(), 60 - expected_ticks);
+
+    // how the instructions are split into runs does not matter
+    CPU split(delay_loop, frontend);
+    for (unsigned int i = 0; i < instructions / 7; ++i) {
+        split.run(7);
+    }
+    EXPECT_EQ(split.registers().get_timer(), whole.registers().get_timer());
+}
+
+TEST(CpuTests, VirtualClockRunsWholeFrames) {
+    constexpr std::array<u8, 8> delay_loop{
+        0x60, 0x3c, // 200: V0 = 60
+        0xf0, 0x15, // 202: delay = V0
+        0xf1, 0x07, // 204: V1 = delay
+        0x12, 0x04, // 206: jump 204
+    };
+    constexpr unsigned int instr_per_frame = 2;
+    constexpr unsigned int frames = 10;
+
+    NullFrontend frontend;
+    CPU cpu(delay_loop, frontend);
+    cpu.set_instr_per_frame(instr_per_frame);
+
+    // the first frame sets the timer and ticks it once at its end
+    for (unsigned int frame = 0; frame < frames; ++frame) {
+        EXPECT_EQ(cpu.run_frame(), instr_per_frame);
+    }
+    EXPECT_EQ(frontend.presented_frames(), frames);
+    EXPECT_EQ(cpu.registers().get_timer(), 60 - frames);
+    EXPECT_EQ(cpu.get_instr_per_sec(), instr_per_frame * timer_hz);
+}
+
+TEST(CpuTests, DefaultSpeedFramesAverageInstrPerSec) {
+    NullFrontend frontend;
+    CPU cpu("roms/test_opcode.ch8", frontend);
+
+    unsigned int executed = 0;
+    for (unsigned int frame = 0; frame < timer_hz; ++frame) {
+        executed += cpu.run_frame();
+    }
+    EXPECT_EQ(executed, instr_per_sec);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <decoder.h>
+#include <ram.h>
+
+#include <array>
+
+TEST(DecoderTests, ExtractsOperands) {
+    auto instruction = decode(Opcode(0xd123));
+
+    EXPECT_EQ(instruction.kind, Instr::LoadSprite);
+    EXPECT_EQ(instruction.x, 0x1);
+    EXPECT_EQ(instruction.y, 0x2);
+    EXPECT_EQ(instruction.n, 0x3);
+    EXPECT_EQ(instruction.nn, 0x23);
+    EXPECT_EQ(instruction.nnn, 0x123);
+}
+
+TEST(DecoderTests, FlattensSubOperations) {
+    EXPECT_EQ(decode(Opcode(0x00e0)).kind, Instr::Clear);
+    EXPECT_EQ(decode(Opcode(0x00ee)).kind, Instr::Return);
+    EXPECT_EQ(decode(Opcode(0x0123)).kind, Instr::MachineRoutine);
+    EXPECT_EQ(decode(Opcode(0x8124)).kind, Instr::Addition);
+    EXPECT_EQ(decode(Opcode(0x812e)).kind, Instr::ShiftLeft);
+    EXPECT_EQ(decode(Opcode(0x8128)).kind, Instr::Unknown);
+    EXPECT_EQ(decode(Opcode(0xe1a1)).kind, Instr::IfKeyPressed);
+    EXPECT_EQ(decode(Opcode(0xf165)).kind, Instr::LoadFromRam);
+    EXPECT_EQ(decode(Opcode(0xf1ff)).kind, Instr::Unknown);
+}
+
+TEST(DecoderTests, DecodesSuperChip) {
+    auto scroll = decode(Opcode(0x00c5));
+    EXPECT_EQ(scroll.kind, Instr::ScrollDown);
+    EXPECT_EQ(scroll.n, 5);
+    EXPECT_EQ(decode(Opcode(0x00fb)).kind, Instr::ScrollRight);
+    EXPECT_EQ(decode(Opcode(0x00fc)).kind, Instr::ScrollLeft);
+    EXPECT_EQ(decode(Opcode(0x00fd)).kind, Instr::Exit);
+    EXPECT_EQ(decode(Opcode(0x00fe)).kind, Instr::LowRes);
+    EXPECT_EQ(decode(Opcode(0x00ff)).kind, Instr::HighRes);
+    EXPECT_EQ(decode(Opcode(0x01c5)).kind, Instr::MachineRoutine);
+    EXPECT_EQ(decode(Opcode(0xf330)).kind, Instr::SetIndexToBigHex);
+    EXPECT_EQ(decode(Opcode(0xf775)).kind, Instr::StoreFlags);
+    EXPECT_EQ(decode(Opcode(0xf785)).kind, Instr::LoadFlags);
+}
+
+TEST(DecoderTests, CacheMatchesFetch) {
+    RAM memory("roms/test_opcode.ch8");
+
+    constexpr u16 pc = 0x200;
+    auto expected = decode(memory.fetch(pc));
+    const auto &cached = memory.fetch_decoded(pc);
+    EXPECT_EQ(cached.kind, expected.kind);
+    EXPECT_EQ(cached.nnn, expected.nnn);
+}
+
+TEST(DecoderTests, StoreInvalidatesCache) {
+    RAM memory("roms/test_opcode.ch8");
+
+    constexpr u16 pc = 0x200;
+    ASSERT_NE(memory.fetch_decoded(pc).kind, Instr::SetIndex);
+
+    // overwrite the second byte of the instruction at pc with ANNN
+    std::array<u8, 2> regs{ 0xa3, 0x45 };
+    memory.store(pc, 1, gsl::make_span(regs));
+    EXPECT_EQ(memory.fetch_decoded(pc).kind, Instr::SetIndex);
+    EXPECT_EQ(memory.fetch_decoded(pc).nnn, 0x345);
+
+    // a bcd write into the low byte changes the operands
+    memory.store_bcd(pc + 1, 123);
+    EXPECT_EQ(memory.fetch_decoded(pc).nnn, 0x301);
+}
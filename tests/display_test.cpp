@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <display.h>
+#include <framebuffer.h>
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+// needs a GL 4.5 context, Mesa's llvmpipe is enough (e.g. under xvfb-run)
+std::unique_ptr<Display> make_hidden_display() {
+    try {
+        return std::make_unique<Display>(false);
+    } catch (const std::runtime_error &) {
+        return nullptr;
+    }
+}
+
+void expect_texture_matches(const Display &display, const Framebuffer &framebuffer) {
+    auto texture = display.read_texture();
+    const int scale = schip_width / framebuffer.width();
+    for (int y = 0; y < schip_height; ++y) {
+        for (int x = 0; x < schip_width; ++x) {
+            EXPECT_EQ(texture.at(y * schip_width + x) != 0, framebuffer.is_set(static_cast<u8>(x / scale), static_cast<u8>(y / scale))) << x << ", " << y;
+        }
+    }
+}
+} // namespace
+
+TEST(DisplayTests, UploadsChangedRowsToTexture) {
+    auto display = make_hidden_display();
+    if (!display) {
+        GTEST_SKIP() << "no OpenGL 4.5 context available";
+    }
+
+    Framebuffer framebuffer;
+    std::array<u8, 4> square{ 0xf0, 0xf0, 0xf0, 0xf0 };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(square), 10, 3));
+    display->present(framebuffer);
+    expect_texture_matches(*display, framebuffer);
+
+    std::array<u8, 1> line{ 0xff };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(line), 60, 31));
+    display->present(framebuffer);
+    expect_texture_matches(*display, framebuffer);
+
+    framebuffer.clear();
+    display->present(framebuffer);
+    expect_texture_matches(*display, framebuffer);
+}
+
+TEST(DisplayTests, RedrawsWhenResolutionChanges) {
+    auto display = make_hidden_display();
+    if (!display) {
+        GTEST_SKIP() << "no OpenGL 4.5 context available";
+    }
+
+    Framebuffer framebuffer;
+    std::array<u8, 2> pair{ 0xff, 0x81 };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(pair), 4, 4));
+    display->present(framebuffer);
+    expect_texture_matches(*display, framebuffer);
+
+    framebuffer.set_high_res(true);
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(pair), 120, 62));
+    display->present(framebuffer);
+    expect_texture_matches(*display, framebuffer);
+
+    framebuffer.set_high_res(false);
+    display->present(framebuffer);
+    expect_texture_matches(*display, framebuffer);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <framebuffer.h>
+#include <ram.h>
+
+#include <algorithm>
+#include <array>
+
+TEST(FramebufferTests, XorsSpriteRows) {
+    Framebuffer framebuffer;
+
+    std::array<u8, 2> pair{ 0b10100000, 0b01000000 };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(pair), 3, 5));
+    EXPECT_TRUE(framebuffer.is_set(3, 5));
+    EXPECT_FALSE(framebuffer.is_set(4, 5));
+    EXPECT_TRUE(framebuffer.is_set(5, 5));
+    EXPECT_TRUE(framebuffer.is_set(4, 6));
+    EXPECT_EQ(framebuffer.row(5)[0], 0b101ULL << 58);
+
+    // only the overlapping pixel is turned off
+    std::array<u8, 1> overlap{ 0b11000000 };
+    EXPECT_TRUE(framebuffer.draw_sprite(Sprite(overlap), 2, 5));
+    EXPECT_TRUE(framebuffer.is_set(2, 5));
+    EXPECT_FALSE(framebuffer.is_set(3, 5));
+    EXPECT_TRUE(framebuffer.is_set(5, 5));
+}
+
+TEST(FramebufferTests, ClipsAtEdgesAndWrapsStart) {
+    Framebuffer framebuffer;
+
+    std::array<u8, 3> block{ 0xff, 0xff, 0xff };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(block), 60, 30));
+    EXPECT_TRUE(framebuffer.is_set(63, 31));
+    EXPECT_FALSE(framebuffer.is_set(0, 30));
+    EXPECT_FALSE(framebuffer.is_set(60, 0));
+
+    // the start position wraps, the sprite itself does not
+    framebuffer.clear();
+    std::array<u8, 1> dot{ 0x80 };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(dot), chip8_width + 1, chip8_height + 2));
+    EXPECT_TRUE(framebuffer.is_set(1, 2));
+}
+
+TEST(FramebufferTests, SpriteStraddlesWordsOnWideScreens) {
+    BasicFramebuffer<128, 64> framebuffer;
+
+    std::array<u8, 1> byte{ 0xff };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(byte), 60, 0));
+    for (u8 x = 60; x < 68; ++x) {
+        EXPECT_TRUE(framebuffer.is_set(x, 0));
+    }
+    EXPECT_FALSE(framebuffer.is_set(59, 0));
+    EXPECT_FALSE(framebuffer.is_set(68, 0));
+    EXPECT_EQ(framebuffer.row(0)[0], 0xfULL);
+    EXPECT_EQ(framebuffer.row(0)[1], 0xfULL << 60);
+
+    std::array<u8, 1> last_pixel{ 0x01 };
+    EXPECT_TRUE(framebuffer.draw_sprite(Sprite(last_pixel), 60, 0));
+    EXPECT_FALSE(framebuffer.is_set(67, 0));
+}
+
+TEST(FramebufferTests, WrapsSpritesAroundEdges) {
+    Framebuffer framebuffer;
+
+    std::array<u8, 3> block{ 0xff, 0xff, 0xff };
+    EXPECT_FALSE(framebuffer.draw_sprite<true>(Sprite(block), 60, 30));
+    EXPECT_TRUE(framebuffer.is_set(63, 31));
+    EXPECT_TRUE(framebuffer.is_set(0, 30));
+    EXPECT_TRUE(framebuffer.is_set(3, 0));
+    EXPECT_FALSE(framebuffer.is_set(4, 0));
+    EXPECT_FALSE(framebuffer.is_set(59, 30));
+
+    // wrapped pixels collide like any other
+    std::array<u8, 1> dot{ 0x01 };
+    EXPECT_TRUE(framebuffer.draw_sprite<true>(Sprite(dot), 60, 0));
+    EXPECT_FALSE(framebuffer.is_set(3, 0));
+
+    BasicFramebuffer<128, 64> wide;
+    std::array<u8, 1> byte{ 0xff };
+    EXPECT_FALSE(wide.draw_sprite<true>(Sprite(byte), 124, 0));
+    EXPECT_EQ(wide.row(0)[1], 0xfULL);
+    EXPECT_EQ(wide.row(0)[0], 0xfULL << 60);
+}
+
+TEST(FramebufferTests, DrawsLargeSpritesAcrossWords) {
+    HighResFramebuffer framebuffer;
+
+    // a 16x16 outline: full first and last rows, the edges in between
+    std::array<u8, large_sprite_size> outline{};
+    outline.at(0) = outline.at(1) = outline.at(30) = outline.at(31) = 0xff;
+    for (std::size_t row = 1; row < 15; ++row) {
+        outline.at(2 * row) = 0x80;
+        outline.at(2 * row + 1) = 0x01;
+    }
+    EXPECT_FALSE(framebuffer.draw_large_sprite(Sprite(outline), 56, 10));
+    EXPECT_TRUE(framebuffer.is_set(56, 10));
+    EXPECT_TRUE(framebuffer.is_set(71, 10));
+    EXPECT_TRUE(framebuffer.is_set(56, 17));
+    EXPECT_FALSE(framebuffer.is_set(57, 17));
+    EXPECT_TRUE(framebuffer.is_set(71, 17));
+    EXPECT_TRUE(framebuffer.is_set(64, 25));
+    EXPECT_FALSE(framebuffer.is_set(72, 10));
+    EXPECT_FALSE(framebuffer.is_set(56, 26));
+
+    // clipped at the bottom unless it wraps
+    framebuffer.clear();
+    EXPECT_FALSE(framebuffer.draw_large_sprite(Sprite(outline), 0, 60));
+    EXPECT_TRUE(framebuffer.is_set(0, 63));
+    EXPECT_FALSE(framebuffer.is_set(0, 0));
+    EXPECT_TRUE(framebuffer.draw_large_sprite<true>(Sprite(outline), 0, 60));
+    EXPECT_TRUE(framebuffer.is_set(15, 11));
+}
+
+TEST(FramebufferTests, ScrollsRowsAndColumns) {
+    HighResFramebuffer framebuffer;
+
+    std::array<u8, 1> byte{ 0xff };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(byte), 60, 0));
+    framebuffer.scroll_right(4);
+    EXPECT_FALSE(framebuffer.is_set(63, 0));
+    EXPECT_TRUE(framebuffer.is_set(64, 0));
+    EXPECT_TRUE(framebuffer.is_set(71, 0));
+    EXPECT_FALSE(framebuffer.is_set(72, 0));
+
+    framebuffer.scroll_left(4);
+    framebuffer.scroll_left(4);
+    EXPECT_TRUE(framebuffer.is_set(56, 0));
+    EXPECT_TRUE(framebuffer.is_set(63, 0));
+    EXPECT_FALSE(framebuffer.is_set(64, 0));
+
+    framebuffer.scroll_down(5);
+    EXPECT_FALSE(framebuffer.is_set(56, 0));
+    EXPECT_TRUE(framebuffer.is_set(56, 5));
+
+    // pixels scrolled past an edge are gone
+    framebuffer.scroll_down(60);
+    EXPECT_TRUE(std::ranges::all_of(framebuffer.words(), [](u64 word) { return word == 0; }));
+}
+
+TEST(FramebufferTests, SwitchesResolution) {
+    Framebuffer framebuffer;
+    EXPECT_FALSE(framebuffer.is_high_res());
+    EXPECT_EQ(framebuffer.width(), chip8_width);
+    EXPECT_EQ(framebuffer.words().size(), chip8_height);
+
+    std::array<u8, 1> dot{ 0x80 };
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(dot), 100, 40));
+    EXPECT_TRUE(framebuffer.is_set(36, 8));
+
+    framebuffer.set_high_res(true);
+    EXPECT_EQ(framebuffer.width(), schip_width);
+    EXPECT_EQ(framebuffer.height(), schip_height);
+    EXPECT_EQ(framebuffer.words_per_row(), 2U);
+    EXPECT_FALSE(framebuffer.draw_sprite(Sprite(dot), 100, 40));
+    EXPECT_TRUE(framebuffer.is_set(100, 40));
+    framebuffer.scroll_left();
+    EXPECT_TRUE(framebuffer.is_set(96, 40));
+
+    // switching back starts from a clear screen
+    framebuffer.set_high_res(false);
+    EXPECT_FALSE(framebuffer.is_set(36, 8));
+}
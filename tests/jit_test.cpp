@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <jit.h>
+#include <null_frontend.h>
+
+#include <array>
+
+namespace {
+// adds 2 to VA, then patches that instruction to add 9 instead and jumps
+// back. VA only reaches 0x0b and halts at 0x208 if the patch is seen
+constexpr std::array<u8, 22> self_modifying_rom{
+    0x6a, 0x00, // 200: VA = 0
+    0x7a, 0x02, // 202: VA += 2
+    0x3a, 0x0b, // 204: skip if VA == 0x0b
+    0x12, 0x0a, // 206: jump 20A
+    0x12, 0x08, // 208: halt
+    0x60, 0x7a, // 20A: V0 = 0x7a
+    0x61, 0x09, // 20C: V1 = 0x09
+    0xa2, 0x02, // 20E: I = 0x202
+    0xf1, 0x55, // 210: store V0..V1 at I
+    0x12, 0x02, // 212: jump 202
+};
+} // namespace
+
+TEST(JitTests, MatchesInterpreter) {
+    constexpr int test_opcode_instructions = 2000;
+
+    NullFrontend switch_frontend;
+    CPU switch_cpu("roms/test_opcode.ch8", switch_frontend, Dispatch::Switch);
+    switch_cpu.run(test_opcode_instructions);
+
+    NullFrontend jit_frontend;
+    CPU jit_cpu("roms/test_opcode.ch8", jit_frontend, Dispatch::Jit);
+    jit_cpu.run(test_opcode_instructions);
+
+    for (u8 y = 0; y < chip8_height; ++y) {
+        for (u8 x = 0; x < chip8_width; ++x) {
+            EXPECT_EQ(switch_cpu.framebuffer().is_set(x, y), jit_cpu.framebuffer().is_set(x, y));
+        }
+    }
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        EXPECT_EQ(switch_cpu.registers().at(reg), jit_cpu.registers().at(reg));
+    }
+    EXPECT_EQ(switch_cpu.registers().get_pc(), jit_cpu.registers().get_pc());
+    EXPECT_EQ(switch_cpu.registers().get_index(), jit_cpu.registers().get_index());
+
+    // blocks longer than one instruction ran natively, not only jump loops
+    if (Jit::is_supported()) {
+        auto stats = jit_cpu.jit_stats();
+        EXPECT_GT(stats.instructions, stats.blocks);
+    }
+}
+
+TEST(JitTests, BlocksStopAtTheBudget) {
+    if (!Jit::is_supported()) {
+        GTEST_SKIP() << "no native code on this host";
+    }
+    // one straight block of 16 increments, longer than the 9 instructions
+    // between two ticks at the default speed
+    std::array<u8, 34> rom{};
+    for (std::size_t i = 0; i < 16; ++i) {
+        rom.at(2 * i) = 0x70;
+        rom.at(2 * i + 1) = 0x01;
+    }
+    rom.at(32) = 0x12;
+    rom.at(33) = 0x20;
+
+    NullFrontend frontend;
+    CPU cpu(rom, frontend, Dispatch::Jit);
+    for (unsigned int count : { 3U, 5U, 8U }) {
+        EXPECT_EQ(cpu.run(count), count);
+    }
+    EXPECT_EQ(cpu.registers().at(0), 16);
+    EXPECT_EQ(cpu.registers().get_pc(), 0x220);
+
+    // every instruction ran natively, split at the budget
+    auto stats = cpu.jit_stats();
+    EXPECT_EQ(stats.instructions, 16U);
+    EXPECT_GT(stats.blocks, 1U);
+}
+
+TEST(JitTests, SelfModifyingCodeInvalidatesBlocks) {
+    NullFrontend frontend;
+    CPU cpu(self_modifying_rom, frontend, Dispatch::Jit);
+    constexpr int instructions = 100;
+    cpu.run(instructions);
+
+    EXPECT_EQ(cpu.registers().at(0xa), 0x0b);
+    EXPECT_EQ(cpu.registers().get_pc(), 0x208);
+}
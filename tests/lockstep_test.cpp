@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <lockstep.h>
+#include <null_frontend.h>
+
+#include <array>
+#include <memory>
+
+namespace {
+constexpr std::size_t lanes = 8;
+
+// V2 is 0x22 on lanes holding key 5 and 0x33 otherwise, then V3 counts
+constexpr std::array<u8, 16> key_branch_rom{
+    0x61, 0x05, // 200: V1 = 5
+    0xe1, 0x9e, // 202: skip if key V1 pressed
+    0x12, 0x0a, // 204: jump 20A
+    0x62, 0x22, // 206: V2 = 0x22
+    0x12, 0x0c, // 208: jump 20C
+    0x62, 0x33, // 20A: V2 = 0x33
+    0x73, 0x01, // 20C: V3 += 1
+    0x12, 0x0c, // 20E: jump 20C
+};
+
+void expect_lane_matches(const Lockstep<lanes> &lockstep, std::size_t lane, CPU &cpu) {
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        EXPECT_EQ(lockstep.reg(lane, reg), cpu.registers().at(reg)) << "lane " << lane << " V" << int(reg);
+    }
+    EXPECT_EQ(lockstep.pc(lane), cpu.registers().get_pc());
+    EXPECT_EQ(lockstep.index(lane), cpu.registers().get_index());
+    for (u8 y = 0; y < chip8_height; ++y) {
+        for (u8 x = 0; x < chip8_width; ++x) {
+            EXPECT_EQ(lockstep.framebuffer(lane).is_set(x, y), cpu.framebuffer().is_set(x, y));
+        }
+    }
+}
+} // namespace
+
+TEST(LockstepTests, MatchesInterpreterOnEveryLane) {
+    constexpr int test_opcode_instructions = 2000;
+    auto rom = read_rom_file("roms/test_opcode.ch8");
+
+    auto lockstep = std::make_unique<Lockstep<lanes>>(rom);
+    lockstep->run(test_opcode_instructions);
+
+    NullFrontend frontend;
+    CPU cpu(rom, frontend, Dispatch::Switch);
+    cpu.run(test_opcode_instructions);
+
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        expect_lane_matches(*lockstep, lane, cpu);
+    }
+}
+
+TEST(LockstepTests, DivergentLanesMatchInterpreter) {
+    constexpr int instructions = 50;
+    constexpr u8 key = 5;
+
+    auto lockstep = std::make_unique<Lockstep<lanes>>(key_branch_rom);
+    for (std::size_t lane = 1; lane < lanes; lane += 2) {
+        lockstep->set_keys(lane, 1 << key);
+    }
+    lockstep->run(instructions);
+
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        NullFrontend frontend;
+        frontend.set_key(key, lane % 2 == 1);
+        CPU cpu(key_branch_rom, frontend, Dispatch::Switch);
+        cpu.run(instructions);
+
+        expect_lane_matches(*lockstep, lane, cpu);
+        EXPECT_EQ(lockstep->reg(lane, 2), lane % 2 == 1 ? 0x22 : 0x33);
+    }
+}
+
+TEST(LockstepTests, MatchesInterpreterWithQuirks) {
+    constexpr int test_opcode_instructions = 2000;
+    using XoChip = Quirks<QuirkProfile::XoChip>;
+    auto rom = read_rom_file("roms/test_opcode.ch8");
+
+    auto lockstep = std::make_unique<Lockstep<lanes, XoChip>>(rom);
+    lockstep->run(test_opcode_instructions);
+
+    NullFrontend frontend;
+    CPU cpu(rom, frontend, Dispatch::Switch, XoChip::profile);
+    cpu.run(test_opcode_instructions);
+
+    EXPECT_EQ(lockstep->pc(0), cpu.registers().get_pc());
+    EXPECT_EQ(lockstep->index(0), cpu.registers().get_index());
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        EXPECT_EQ(lockstep->reg(0, reg), cpu.registers().at(reg));
+    }
+    EXPECT_TRUE(std::equal(cpu.framebuffer().words().begin(), cpu.framebuffer().words().end(), lockstep->framebuffer(0).words().begin()));
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <chip8/chip8.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+// draws digit 0 at (0, 0), then waits for key 5 and draws it over at (8, 0)
+constexpr std::array<std::uint8_t, 18> draw_rom{
+    0x60, 0x00, // 200: V0 = 0
+    0xf0, 0x29, // 202: I = digit V0
+    0xd0, 0x05, // 204: draw at V0, V0
+    0x61, 0x05, // 206: V1 = 5
+    0xe1, 0xa1, // 208: skip if key V1 not pressed
+    0x12, 0x0e, // 20A: jump 20E
+    0x12, 0x08, // 20C: jump 208
+    0x62, 0x08, // 20E: V2 = 8
+    0xd2, 0x05, // 210: draw at V2, V0
+};
+
+// calls itself until the stack overflows
+constexpr std::array<std::uint8_t, 2> recursive_rom{ 0x22, 0x00 };
+} // namespace
+
+TEST(MachineTests, StepsAndReadsStateInPlace) {
+    Machine machine(draw_rom);
+    auto state = machine.state();
+    auto screen = machine.screen();
+
+    EXPECT_EQ(state.pc, 0x200);
+    EXPECT_FALSE(screen.is_set(0, 0));
+    EXPECT_EQ(machine.step(3), 3);
+
+    // the views follow the machine without being fetched again
+    EXPECT_EQ(state.v[0], 0);
+    EXPECT_TRUE(screen.is_set(0, 0));
+    EXPECT_EQ(screen.words.data(), machine.screen().words.data());
+    EXPECT_EQ(machine.state().pc, 0x206);
+    EXPECT_EQ(state.memory[0x200], 0x60);
+    EXPECT_EQ(screen.width, 64);
+    EXPECT_EQ(screen.height, 32);
+    EXPECT_EQ(screen.words.size(), 32);
+}
+
+TEST(MachineTests, KeysComeFromTheMask) {
+    Machine machine(draw_rom, 10);
+    EXPECT_EQ(machine.run_frames(3), 30);
+    EXPECT_FALSE(machine.screen().is_set(8, 0));
+
+    machine.set_keys(1 << 5);
+    machine.run_frames(1);
+    EXPECT_TRUE(machine.screen().is_set(8, 0));
+    EXPECT_EQ(machine.state().v[2], 8);
+}
+
+TEST(MachineTests, StopsCountingAtATrap) {
+    Machine machine(recursive_rom);
+    EXPECT_EQ(machine.step(100), 16);
+    EXPECT_TRUE(machine.state().trapped);
+    EXPECT_EQ(machine.state().stack.size(), 16);
+    EXPECT_EQ(machine.step(10), 0);
+    EXPECT_EQ(machine.run_frames(10), 0);
+}
+
+TEST(MachineTests, RejectsRomsThatDoNotFit) {
+    std::vector<std::uint8_t> rom(4096, 0);
+    EXPECT_THROW(Machine{ rom }, std::runtime_error);
+}
+
+TEST(MachineTests, InstancesAreIndependent) {
+    std::vector<Machine> machines;
+    for (int i = 0; i < 4; ++i) {
+        machines.emplace_back(draw_rom, 10);
+    }
+    machines[1].set_keys(1 << 5);
+    for (auto &machine : machines) {
+        machine.run_frames(2);
+    }
+
+    EXPECT_TRUE(machines[1].screen().is_set(8, 0));
+    EXPECT_FALSE(machines[0].screen().is_set(8, 0));
+
+    auto moved = std::move(machines[1]);
+    EXPECT_TRUE(moved.screen().is_set(8, 0));
+}
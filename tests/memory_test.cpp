@@ -2,6 +2,8 @@
 
 #include <ram.h>
 
+#include <array>
+
 static constexpr u16 test_opcode = 0x1234;
 
 TEST(MemoryTests, OpcodeNibbles) {
@@ -47,3 +49,16 @@ TEST(MemoryTests, StoreToIndex) {
     EXPECT_EQ(memory.fetch_i(i + 1), 2);
     EXPECT_EQ(memory.fetch_i(i + 2), 3);
 }
+
+TEST(MemoryTests, SpriteWrapsAroundEndOfMemory) {
+    RAM memory("roms/test_opcode.ch8");
+    std::array<u8, 4> regs{ 0x11, 0x22, 0x33, 0x44 };
+    memory.store(default_memory_size - 2, 1, gsl::span<u8>(regs));
+
+    auto sprite = memory.get_sprite(default_memory_size - 2, 4);
+    ASSERT_EQ(sprite.size(), 4);
+    EXPECT_EQ(sprite[0], 0x11);
+    EXPECT_EQ(sprite[1], 0x22);
+    EXPECT_EQ(sprite[2], memory.fetch(0).get_byte(1));
+    EXPECT_EQ(sprite[3], memory.fetch(0).get_byte(0));
+}
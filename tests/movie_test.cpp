@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <movie.h>
+#include <null_frontend.h>
+#include <snapshot.h>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace {
+// sums random numbers into V1 and counts the instructions run with key 0 held
+constexpr std::array<u8, 12> random_keys_rom{
+    0xc0, 0xff, // 200: V0 = random
+    0x81, 0x04, // 202: V1 += V0
+    0xe2, 0x9e, // 204: skip if key V2 pressed
+    0x12, 0x00, // 206: jump 200
+    0x73, 0x01, // 208: V3 += 1
+    0x12, 0x00, // 20A: jump 200
+};
+
+constexpr unsigned int instr_per_frame = 9;
+constexpr u32 frames = 300;
+
+u64 hash_of(const CPU &cpu) {
+    auto snapshot = std::make_unique<Snapshot>();
+    cpu.save(*snapshot);
+    return state_hash(*snapshot);
+}
+
+// key 0 goes down and up in uneven stretches
+Movie record_session(u32 seed, unsigned int keyframe_interval = 0) {
+    NullFrontend frontend;
+    CPU cpu(random_keys_rom, frontend);
+    Movie movie(random_keys_rom, seed, instr_per_frame, keyframe_interval);
+    prepare_replay(movie, cpu);
+
+    for (u32 frame = 0; frame < frames; ++frame) {
+        frontend.set_key(0, frame % 37 > 20);
+        movie.record(cpu, key_mask(frontend));
+        cpu.step_frame();
+    }
+
+    auto snapshot = std::make_unique<Snapshot>();
+    cpu.save(*snapshot);
+    movie.finish(*snapshot);
+    return movie;
+}
+
+class MovieTests : public testing::Test {
+  protected:
+    void TearDown() override {
+        std::filesystem::remove(m_path);
+    }
+
+    // one file per test, so tests can run in parallel
+    std::filesystem::path m_path = std::filesystem::temp_directory_path() / (std::string("chip8_movie_test_") + testing::UnitTest::GetInstance()->current_test_info()->name() + ".c8m");
+};
+} // namespace
+
+TEST_F(MovieTests, StoresOnlyKeyChanges) {
+    auto movie = record_session(42);
+
+    EXPECT_EQ(movie.frames(), frames);
+    // a press and a release every 37 frames, the last stretch ends before its press
+    ASSERT_EQ(movie.changes().size(), 2 * (frames / 37));
+    EXPECT_EQ(movie.changes().front().frame, 21);
+    EXPECT_EQ(movie.changes().front().keys, 1);
+    EXPECT_EQ(movie.keys_at(20), 0);
+    EXPECT_EQ(movie.keys_at(21), 1);
+    EXPECT_EQ(movie.keys_at(37), 0);
+}
+
+TEST_F(MovieTests, ReplayEndsOnRecordedState) {
+    auto recorded = record_session(42);
+    recorded.save(m_path);
+    auto movie = Movie::load(m_path);
+
+    ASSERT_TRUE(movie.is_for(random_keys_rom));
+    EXPECT_EQ(movie.seed(), 42);
+    EXPECT_EQ(movie.instr_per_frame(), instr_per_frame);
+    EXPECT_EQ(movie.frames(), recorded.frames());
+    EXPECT_EQ(movie.final_hash(), recorded.final_hash());
+
+    NullFrontend frontend;
+    CPU cpu(random_keys_rom, frontend);
+    prepare_replay(movie, cpu);
+    replay(movie, cpu, frontend, 0, movie.frames());
+
+    EXPECT_EQ(hash_of(cpu), movie.final_hash());
+}
+
+TEST_F(MovieTests, ReplayDependsOnSeedAndKeys) {
+    auto movie = record_session(42);
+
+    EXPECT_NE(record_session(43).final_hash(), movie.final_hash());
+
+    // the same seed without the key presses
+    NullFrontend frontend;
+    CPU cpu(random_keys_rom, frontend);
+    prepare_replay(movie, cpu);
+    for (u32 frame = 0; frame < frames; ++frame) {
+        cpu.step_frame();
+    }
+    EXPECT_NE(hash_of(cpu), movie.final_hash());
+}
+
+TEST_F(MovieTests, ReplaysSplitIntoParts) {
+    auto movie = record_session(7);
+
+    NullFrontend frontend;
+    CPU cpu(random_keys_rom, frontend);
+    prepare_replay(movie, cpu);
+    replay(movie, cpu, frontend, 0, 100);
+    replay(movie, cpu, frontend, 100, 250);
+    replay(movie, cpu, frontend, 250, movie.frames());
+
+    EXPECT_EQ(hash_of(cpu), movie.final_hash());
+}
+
+TEST_F(MovieTests, RejectsOtherFiles) {
+    EXPECT_THROW(static_cast<void>(Movie::load(m_path)), std::runtime_error);
+
+    std::ofstream(m_path, std::ios::binary) << "not a movie";
+    EXPECT_THROW(static_cast<void>(Movie::load(m_path)), std::runtime_error);
+
+    auto movie = record_session(1);
+    std::array<u8, 2> other_rom{ 0x12, 0x00 };
+    EXPECT_FALSE(movie.is_for(other_rom));
+}
+
+TEST_F(MovieTests, IndexesKeyframes) {
+    record_session(3, 64).save(m_path);
+    auto movie = Movie::load(m_path);
+
+    ASSERT_EQ(movie.keyframes().size(), 5);
+    EXPECT_EQ(movie.segments(), 5);
+    for (std::size_t i = 0; i < movie.keyframes().size(); ++i) {
+        EXPECT_EQ(movie.keyframes()[i].frame, i * 64);
+    }
+    EXPECT_EQ(movie.keyframe_before(0), 0);
+    EXPECT_EQ(movie.keyframe_before(63), 0);
+    EXPECT_EQ(movie.keyframe_before(64), 1);
+    EXPECT_EQ(movie.keyframe_before(frames), 4);
+
+    auto snapshot = std::make_unique<Snapshot>();
+    movie.keyframe(2, *snapshot);
+    EXPECT_EQ(state_hash(*snapshot), movie.keyframes()[2].hash);
+}
+
+TEST_F(MovieTests, SeeksFromKeyframes) {
+    record_session(3, 64).save(m_path);
+    auto movie = Movie::load(m_path);
+
+    NullFrontend frontend;
+    CPU from_start(random_keys_rom, frontend);
+    prepare_replay(movie, from_start);
+    u32 replayed = 0;
+    for (u32 frame : { 0U, 50U, 64U, 200U, frames }) {
+        replay(movie, from_start, frontend, replayed, frame);
+        replayed = frame;
+
+        NullFrontend seek_frontend;
+        CPU seeked(random_keys_rom, seek_frontend);
+        seek(movie, seeked, seek_frontend, frame);
+        EXPECT_EQ(hash_of(seeked), hash_of(from_start)) << "frame " << frame;
+    }
+}
+
+TEST_F(MovieTests, VerifiesSegments) {
+    record_session(3, 64).save(m_path);
+    auto movie = Movie::load(m_path);
+    for (std::size_t segment = 0; segment < movie.segments(); ++segment) {
+        EXPECT_TRUE(verify_segment(movie, random_keys_rom, segment)) << "segment " << segment;
+    }
+
+    // without keyframes the whole movie is one segment
+    auto plain = record_session(3);
+    EXPECT_EQ(plain.segments(), 1);
+    EXPECT_TRUE(verify_segment(plain, random_keys_rom, 0));
+}
+
+TEST_F(MovieTests, FindsTheSegmentThatDiverged) {
+    record_session(3, 64).save(m_path);
+    auto offset = Movie::load(m_path).keyframes()[2].offset;
+
+    // poke memory the rom never touches inside the third keyframe
+    auto snapshot = std::make_unique<Snapshot>();
+    auto memory_offset = reinterpret_cast<const u8 *>(snapshot->memory.data()) - reinterpret_cast<const u8 *>(snapshot.get());
+    {
+        std::fstream file(m_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(offset) + memory_offset + 0x800);
+        file.put(0x55);
+    }
+
+    auto movie = Movie::load(m_path);
+    for (std::size_t segment = 0; segment < movie.segments(); ++segment) {
+        EXPECT_EQ(verify_segment(movie, random_keys_rom, segment), segment != 2) << "segment " << segment;
+    }
+}
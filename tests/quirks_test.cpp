@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <chip8/chip8.h>
+#include <cpu.h>
+#include <null_frontend.h>
+#include <quirks.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace {
+constexpr std::array<QuirkProfile, quirk_profile_count> profiles{ QuirkProfile::Chip8, QuirkProfile::CosmacVip, QuirkProfile::SuperChip, QuirkProfile::XoChip };
+constexpr std::array<Dispatch, 3> engines{ Dispatch::Switch, Dispatch::Threaded, Dispatch::Jit };
+
+struct Session {
+    explicit Session(const std::vector<u8> &rom, QuirkProfile quirks, Dispatch dispatch = Dispatch::Switch) : cpu(rom, frontend, dispatch, quirks) {}
+
+    NullFrontend frontend;
+    CPU cpu;
+};
+} // namespace
+
+TEST(QuirksTests, ParsesProfileNames) {
+    for (auto profile : profiles) {
+        EXPECT_EQ(parse_quirk_profile(quirk_profile_name(profile)), profile);
+    }
+    EXPECT_FALSE(parse_quirk_profile("superchip").has_value());
+}
+
+TEST(QuirksTests, ShiftReadsVyWithShiftVy) {
+    const std::vector<u8> rom{
+        0x61, 0x81, // 200: V1 = 0x81
+        0x60, 0x02, // 202: V0 = 0x02
+        0x80, 0x16, // 204: V0 = V? >> 1
+    };
+    for (auto profile : profiles) {
+        Session run(rom, profile);
+        run.cpu.run(3);
+        bool shift_vy = quirk_set(profile).shift_vy;
+        EXPECT_EQ(run.cpu.registers().at(0), shift_vy ? 0x40 : 0x01) << quirk_profile_name(profile);
+        EXPECT_EQ(run.cpu.registers().at(0xf), shift_vy ? 1 : 0) << quirk_profile_name(profile);
+    }
+}
+
+TEST(QuirksTests, JumpAddsVxWithJumpVx) {
+    const std::vector<u8> rom{
+        0x60, 0x04, // 200: V0 = 4
+        0x62, 0x08, // 202: V2 = 8
+        0xb2, 0x06, // 204: jump 206 + V0 or V2
+    };
+    for (auto profile : profiles) {
+        Session run(rom, profile);
+        run.cpu.run(3);
+        EXPECT_EQ(run.cpu.registers().get_pc(), quirk_set(profile).jump_vx ? 0x20e : 0x20a) << quirk_profile_name(profile);
+    }
+}
+
+TEST(QuirksTests, LogicClearsVfWithVfReset) {
+    const std::vector<u8> rom{
+        0x6f, 0x05, // 200: VF = 5
+        0x60, 0x01, // 202: V0 = 1
+        0x80, 0x01, // 204: V0 |= V0
+    };
+    for (auto profile : profiles) {
+        Session run(rom, profile);
+        run.cpu.run(3);
+        EXPECT_EQ(run.cpu.registers().at(0xf), quirk_set(profile).vf_reset ? 0 : 5) << quirk_profile_name(profile);
+    }
+}
+
+TEST(QuirksTests, StoreAndLoadAdvanceIndexWithIncrementIndex) {
+    const std::vector<u8> rom{
+        0xa3, 0x00, // 200: I = 0x300
+        0xf1, 0x55, // 202: store V0..V1
+        0xf2, 0x65, // 204: load V0..V2
+    };
+    for (auto profile : profiles) {
+        Session run(rom, profile);
+        run.cpu.run(3);
+        EXPECT_EQ(run.cpu.registers().get_index(), quirk_set(profile).increment_index ? 0x305 : 0x300) << quirk_profile_name(profile);
+    }
+}
+
+TEST(QuirksTests, SpritesWrapWithWrapSprites) {
+    const std::vector<u8> rom{
+        0x60, 0x3e, // 200: V0 = 62
+        0x61, 0x1e, // 202: V1 = 30
+        0xf2, 0x29, // 204: I = font of V2 = 0
+        0xd0, 0x15, // 206: draw the 0 at 62, 30
+    };
+    for (auto profile : profiles) {
+        Session run(rom, profile);
+        run.cpu.run(4);
+        bool wrap = quirk_set(profile).wrap_sprites;
+        EXPECT_TRUE(run.cpu.framebuffer().is_set(62, 30)) << quirk_profile_name(profile);
+        EXPECT_EQ(run.cpu.framebuffer().is_set(0, 30), wrap) << quirk_profile_name(profile);
+        EXPECT_EQ(run.cpu.framebuffer().is_set(62, 0), wrap) << quirk_profile_name(profile);
+    }
+}
+
+TEST(QuirksTests, DrawWaitsForTickWithDisplayWait) {
+    constexpr unsigned int instr_per_frame = 10;
+    const std::vector<u8> rom{
+        0xd0, 0x05, // 200: draw
+        0x71, 0x01, // 202: V1 += 1
+        0x12, 0x00, // 204: jump 200
+    };
+    for (auto dispatch : engines) {
+        Session vip(rom, QuirkProfile::CosmacVip, dispatch);
+        vip.cpu.set_instr_per_frame(instr_per_frame);
+        EXPECT_EQ(vip.cpu.step_frame(), 1);
+        EXPECT_EQ(vip.cpu.step_frame(), 3);
+        EXPECT_EQ(vip.cpu.registers().at(1), 1);
+
+        Session chip8(rom, QuirkProfile::Chip8, dispatch);
+        chip8.cpu.set_instr_per_frame(instr_per_frame);
+        EXPECT_EQ(chip8.cpu.step_frame(), instr_per_frame);
+    }
+}
+
+TEST(QuirksTests, DisplayWaitSurvivesSnapshots) {
+    const std::vector<u8> rom{
+        0xd0, 0x05, // 200: draw
+        0x71, 0x01, // 202: V1 += 1
+        0x12, 0x00, // 204: jump 200
+    };
+    Session run(rom, QuirkProfile::CosmacVip);
+    run.cpu.set_instr_per_frame(10);
+    run.cpu.run(2);
+
+    auto snapshot = std::make_unique<Snapshot>();
+    run.cpu.save(*snapshot);
+    EXPECT_TRUE(snapshot->display_wait);
+
+    Session restored(rom, QuirkProfile::CosmacVip);
+    restored.cpu.load(*snapshot);
+    EXPECT_EQ(restored.cpu.run(8), 0);
+    EXPECT_EQ(restored.cpu.run(1), 1);
+}
+
+TEST(QuirksTests, EnginesAgreeUnderEveryProfile) {
+    constexpr int test_opcode_instructions = 2000;
+    auto rom = read_rom_file("roms/test_opcode.ch8");
+
+    for (auto profile : profiles) {
+        Session reference(rom, profile, Dispatch::Switch);
+        auto expected = reference.cpu.run(test_opcode_instructions);
+        for (auto dispatch : { Dispatch::Threaded, Dispatch::Jit }) {
+            Session run(rom, profile, dispatch);
+            EXPECT_EQ(run.cpu.run(test_opcode_instructions), expected) << quirk_profile_name(profile);
+            for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+                EXPECT_EQ(run.cpu.registers().at(reg), reference.cpu.registers().at(reg)) << quirk_profile_name(profile);
+            }
+            EXPECT_EQ(run.cpu.registers().get_pc(), reference.cpu.registers().get_pc()) << quirk_profile_name(profile);
+            EXPECT_EQ(run.cpu.registers().get_index(), reference.cpu.registers().get_index()) << quirk_profile_name(profile);
+            EXPECT_TRUE(std::equal(run.cpu.framebuffer().words().begin(), run.cpu.framebuffer().words().end(), reference.cpu.framebuffer().words().begin())) << quirk_profile_name(profile);
+        }
+    }
+}
+
+TEST(QuirksTests, MachineTakesProfile) {
+    const std::vector<u8> rom{
+        0xd0, 0x05, // 200: draw
+        0x71, 0x01, // 202: V1 += 1
+    };
+    Machine vip(rom, 10, QuirkProfile::CosmacVip);
+    EXPECT_EQ(vip.step(2), 1);
+
+    Machine chip8(rom, 10);
+    EXPECT_EQ(chip8.step(2), 2);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <null_frontend.h>
+#include <rewind.h>
+
+#include <memory>
+#include <vector>
+
+namespace {
+constexpr unsigned int instr_per_frame = 8;
+constexpr unsigned int keyframe_interval = 10;
+
+struct Frame {
+    u16 pc;
+    u16 index;
+    std::vector<u8> regs;
+    std::vector<u64> top_row;
+};
+
+Frame frame_of(const CPU &cpu) {
+    auto top_row = cpu.framebuffer().row(0);
+    Frame frame{ cpu.registers().get_pc(), cpu.registers().get_index(), {}, { top_row.begin(), top_row.end() } };
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        frame.regs.push_back(cpu.registers().at(reg));
+    }
+    return frame;
+}
+
+void expect_frame(const CPU &cpu, const Frame &frame) {
+    auto current = frame_of(cpu);
+    EXPECT_EQ(current.pc, frame.pc);
+    EXPECT_EQ(current.index, frame.index);
+    EXPECT_EQ(current.regs, frame.regs);
+    EXPECT_EQ(current.top_row, frame.top_row);
+}
+} // namespace
+
+TEST(RewindTests, RestoresEarlierFrames) {
+    constexpr unsigned int frames = 35;
+
+    NullFrontend frontend;
+    CPU cpu("roms/test_opcode.ch8", frontend);
+    RewindBuffer buffer(RewindBuffer::default_memory_cap, keyframe_interval);
+    auto snapshot = std::make_unique<Snapshot>();
+
+    std::vector<Frame> history;
+    for (unsigned int frame = 0; frame < frames; ++frame) {
+        cpu.run(instr_per_frame);
+        cpu.save(*snapshot);
+        buffer.record(*snapshot);
+        history.push_back(frame_of(cpu));
+    }
+    ASSERT_EQ(buffer.size(), frames);
+
+    // a delta frame, then a keyframe, then past the start
+    ASSERT_TRUE(buffer.rewind(3, *snapshot));
+    cpu.load(*snapshot);
+    expect_frame(cpu, history.at(frames - 4));
+    EXPECT_EQ(buffer.size(), frames - 3);
+
+    ASSERT_TRUE(buffer.rewind(11, *snapshot));
+    cpu.load(*snapshot);
+    expect_frame(cpu, history.at(frames - 15));
+
+    EXPECT_FALSE(buffer.rewind(frames, *snapshot));
+
+    // recording continues from the restored frame
+    cpu.run(instr_per_frame);
+    cpu.save(*snapshot);
+    buffer.record(*snapshot);
+    ASSERT_TRUE(buffer.rewind(1, *snapshot));
+    cpu.load(*snapshot);
+    expect_frame(cpu, history.at(frames - 15));
+}
+
+TEST(RewindTests, StaysUnderMemoryCap) {
+    constexpr std::size_t memory_cap = 4 * sizeof(Snapshot);
+
+    NullFrontend frontend;
+    CPU cpu("roms/test_opcode.ch8", frontend);
+    RewindBuffer buffer(memory_cap, keyframe_interval);
+    auto snapshot = std::make_unique<Snapshot>();
+
+    for (unsigned int frame = 0; frame < 200; ++frame) {
+        cpu.run(instr_per_frame);
+        cpu.save(*snapshot);
+        buffer.record(*snapshot);
+        EXPECT_LE(buffer.memory_used(), memory_cap);
+    }
+    EXPECT_GE(buffer.size(), keyframe_interval);
+    EXPECT_LT(buffer.size(), 200);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <ram.h>
+#include <rom_db.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+Sha1 sha1_of(std::string_view text) {
+    return sha1(gsl::span<const u8>(reinterpret_cast<const u8 *>(text.data()), text.size()));
+}
+
+// one file per test, so tests can run in parallel
+std::filesystem::path write_overrides(const std::string &text) {
+    auto path = std::filesystem::temp_directory_path() / (std::string("chip8_rom_db_test_") + testing::UnitTest::GetInstance()->current_test_info()->name() + ".txt");
+    std::ofstream file(path);
+    file << text;
+    return path;
+}
+} // namespace
+
+static_assert(parse_sha1("000102030405060708090a0b0c0d0e0f10111213")[19] == 0x13);
+
+TEST(RomDbTests, HashesLikeSha1) {
+    EXPECT_EQ(sha1_of(""), parse_sha1("da39a3ee5e6b4b0d3255bfef95601890afd80709"));
+    EXPECT_EQ(sha1_of("abc"), parse_sha1("a9993e364706816aba3e25717850c26c9cd0d89d"));
+    // two blocks once padded
+    EXPECT_EQ(sha1_of("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"), parse_sha1("84983e441c3bd26ebaae4aa1f95129e5e54670f1"));
+}
+
+TEST(RomDbTests, KnowsRomsInTheTree) {
+    auto logo = builtin_rom_info(sha1(read_rom_file("roms/IBM_Logo.ch8")));
+    ASSERT_TRUE(logo.has_value());
+    EXPECT_EQ(logo->quirks, QuirkProfile::CosmacVip);
+    EXPECT_EQ(logo->variant, Variant::Chip8);
+
+    auto test_opcode = builtin_rom_info(sha1(read_rom_file("roms/test_opcode.ch8")));
+    ASSERT_TRUE(test_opcode.has_value());
+    EXPECT_EQ(test_opcode->quirks, QuirkProfile::Chip8);
+
+    EXPECT_FALSE(builtin_rom_info(sha1_of("not a rom")).has_value());
+}
+
+TEST(RomDbTests, OverridesWinOverBuiltins) {
+    auto rom = read_rom_file("roms/IBM_Logo.ch8");
+    auto path = write_overrides(
+        "# sha1 quirks instr_per_frame variant\n"
+        "1ba58656810b67fd131eb9af3e3987863bf26c90 xochip 30 xochip\n"
+        "a9993e364706816aba3e25717850c26c9cd0d89d schip\n");
+
+    RomDatabase database;
+    database.load_overrides(path);
+
+    auto logo = database.find(rom);
+    ASSERT_TRUE(logo.has_value());
+    EXPECT_EQ(logo->quirks, QuirkProfile::XoChip);
+    EXPECT_EQ(logo->instr_per_frame, 30);
+    EXPECT_EQ(logo->variant, Variant::XoChip);
+
+    auto abc = database.find(sha1_of("abc"));
+    ASSERT_TRUE(abc.has_value());
+    EXPECT_EQ(abc->quirks, QuirkProfile::SuperChip);
+    EXPECT_EQ(abc->instr_per_frame, 0);
+
+    // built-in entries stay visible
+    EXPECT_TRUE(database.find(read_rom_file("roms/test_opcode.ch8")).has_value());
+}
+
+TEST(RomDbTests, SkipsCommentsAndBlankLines) {
+    auto path = write_overrides(
+        "  # indented comment\n"
+        " \t \n"
+        "1ba58656810b67fd131eb9af3e3987863bf26c90 schip 12 # faster\n"
+        "a9993e364706816aba3e25717850c26c9cd0d89d vip# no space\n");
+
+    RomDatabase database;
+    database.load_overrides(path);
+
+    auto logo = database.find(read_rom_file("roms/IBM_Logo.ch8"));
+    ASSERT_TRUE(logo.has_value());
+    EXPECT_EQ(logo->quirks, QuirkProfile::SuperChip);
+    EXPECT_EQ(logo->instr_per_frame, 12);
+    auto abc = database.find(sha1_of("abc"));
+    ASSERT_TRUE(abc.has_value());
+    EXPECT_EQ(abc->quirks, QuirkProfile::CosmacVip);
+}
+
+TEST(RomDbTests, RejectsBadOverrides) {
+    RomDatabase database;
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba5 chip8\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba58656810b67fd131eb9af3e3987863bf26c90 superchip\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba58656810b67fd131eb9af3e3987863bf26c90 chip8 10 vip\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba58656810b67fd131eb9af3e3987863bf26c90 vip fast\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba58656810b67fd131eb9af3e3987863bf26c90 vip -5\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba58656810b67fd131eb9af3e3987863bf26c90 vip 0\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba58656810b67fd131eb9af3e3987863bf26c90 vip 10x\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides(write_overrides("1ba58656810b67fd131eb9af3e3987863bf26c90 vip 10 schip extra\n")), std::runtime_error);
+    EXPECT_THROW(database.load_overrides("no/such/file"), std::runtime_error);
+}
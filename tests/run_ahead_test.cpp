@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <null_frontend.h>
+#include <run_ahead.h>
+
+#include <array>
+
+namespace {
+// checks key 5 every third timer tick and draws a digit once it is down
+constexpr std::array<u8, 24> key_check_rom{
+    0x60, 0x05, // 200: V0 = 5
+    0x61, 0x03, // 202: V1 = 3
+    0xe0, 0x9e, // 204: skip if key V0 pressed
+    0x12, 0x0e, // 206: jump 20E
+    0xf0, 0x29, // 208: I = digit V0
+    0xd0, 0x05, // 20A: draw at V0, V0
+    0x12, 0x0c, // 20C: halt
+    0xf1, 0x15, // 20E: delay = V1
+    0xf2, 0x07, // 210: V2 = delay
+    0x32, 0x00, // 212: skip if V2 == 0
+    0x12, 0x10, // 214: jump 210
+    0x12, 0x04, // 216: jump 204
+};
+
+constexpr unsigned int instr_per_frame = 8;
+constexpr unsigned int press_frame = 7;
+
+// keeps the last presented screen
+class RecordingFrontend : public NullFrontend {
+  public:
+    void present(const Framebuffer &framebuffer) noexcept override {
+        NullFrontend::present(framebuffer);
+        m_last = framebuffer;
+    }
+
+    [[nodiscard]] const Framebuffer &last() const noexcept {
+        return m_last;
+    }
+
+  private:
+    Framebuffer m_last;
+};
+
+// frames from pressing the key until the digit is presented
+unsigned int latency(unsigned int run_ahead_frames) {
+    RecordingFrontend frontend;
+    CPU cpu(key_check_rom, frontend);
+    cpu.set_instr_per_frame(instr_per_frame);
+    RunAhead run_ahead(run_ahead_frames);
+
+    for (unsigned int frame = 0; frame < 100; ++frame) {
+        frontend.set_key(5, frame >= press_frame);
+        if (run_ahead_frames > 0) {
+            run_ahead.run_frame(cpu, frontend);
+        } else {
+            cpu.run_frame();
+        }
+        if (frontend.last().is_set(5, 5)) {
+            return frame - press_frame;
+        }
+    }
+    return 100;
+}
+} // namespace
+
+TEST(RunAheadTests, PresentsReactionFramesEarlier) {
+    constexpr unsigned int frames_ahead = 2;
+
+    auto plain = latency(0);
+    ASSERT_GE(plain, frames_ahead);
+    EXPECT_EQ(latency(frames_ahead), plain - frames_ahead);
+}
+
+TEST(RunAheadTests, MachineStateIsNotAhead) {
+    NullFrontend frontend;
+    CPU plain(key_check_rom, frontend);
+    plain.set_instr_per_frame(instr_per_frame);
+
+    CPU ahead(key_check_rom, frontend);
+    ahead.set_instr_per_frame(instr_per_frame);
+    RunAhead run_ahead(3);
+
+    for (unsigned int frame = 0; frame < 20; ++frame) {
+        plain.run_frame();
+        run_ahead.run_frame(ahead, frontend);
+        EXPECT_EQ(ahead.registers().get_pc(), plain.registers().get_pc());
+        EXPECT_EQ(ahead.registers().get_timer(), plain.registers().get_timer());
+    }
+}
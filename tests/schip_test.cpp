@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include <chip8/chip8.h>
+#include <cpu.h>
+#include <lockstep.h>
+#include <null_frontend.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace {
+constexpr u16 large_sprite_addr = 0x230;
+
+// every SUPER-CHIP instruction once, ending at 00FD
+std::vector<u8> schip_rom() {
+    std::vector<u8> rom{
+        0x00, 0xff, // 200: high res
+        0x60, 0x78, // 202: V0 = 120
+        0x61, 0x3a, // 204: V1 = 58
+        0x62, 0x05, // 206: V2 = 5
+        0xf2, 0x30, // 208: I = big digit V2
+        0xd0, 0x1a, // 20A: draw it at 120, 58, clipped
+        0xa2, 0x30, // 20C: I = 230
+        0xd1, 0x00, // 20E: draw 16x16 at 58, 120 % 64
+        0x00, 0xc3, // 210: scroll down 3
+        0x00, 0xfb, // 212: scroll right
+        0x00, 0xfc, // 214: scroll left
+        0x00, 0xfc, // 216: scroll left
+        0xf2, 0x75, // 218: flags = V0..V2
+        0x70, 0x01, // 21A: V0 += 1
+        0xf2, 0x85, // 21C: V0..V2 = flags
+        0x00, 0xfe, // 21E: low res
+        0xd1, 0x00, // 220: draw 16x16 at 58, 120 % 32
+        0x00, 0xc1, // 222: scroll down 1
+        0x00, 0xfd, // 224: exit
+    };
+    rom.resize(large_sprite_addr - rom_start);
+    for (u8 i = 0; i < large_sprite_size; ++i) {
+        rom.push_back(static_cast<u8>(0x5a ^ (i * 37)));
+    }
+    return rom;
+}
+
+struct Session {
+    explicit Session(const std::vector<u8> &rom, Dispatch dispatch = Dispatch::Switch) : cpu(rom, frontend, dispatch) {}
+
+    NullFrontend frontend;
+    CPU cpu;
+};
+
+void expect_same_screen(const Framebuffer &lhs, const Framebuffer &rhs) {
+    EXPECT_EQ(lhs.is_high_res(), rhs.is_high_res());
+    EXPECT_TRUE(std::ranges::equal(lhs.words(), rhs.words()));
+}
+} // namespace
+
+TEST(SchipTests, HighResDrawsLargeSprites) {
+    std::vector<u8> rom{
+        0x00, 0xff, // 200: high res
+        0x60, 0x3c, // 202: V0 = 60
+        0x61, 0x08, // 204: V1 = 8
+        0xa2, 0x0c, // 206: I = 20C
+        0xd0, 0x10, // 208: draw 16x16 at 60, 8
+        0x12, 0x0a, // 20A: jump 20A
+    };
+    rom.insert(rom.end(), large_sprite_size, 0xff);
+
+    Session run(rom);
+    run.cpu.run(5);
+    const auto &framebuffer = run.cpu.framebuffer();
+    EXPECT_TRUE(framebuffer.is_high_res());
+    EXPECT_EQ(framebuffer.width(), schip_width);
+    EXPECT_TRUE(framebuffer.is_set(60, 8));
+    EXPECT_TRUE(framebuffer.is_set(75, 23));
+    EXPECT_FALSE(framebuffer.is_set(76, 8));
+    EXPECT_FALSE(framebuffer.is_set(60, 24));
+    EXPECT_EQ(run.cpu.registers().at(0xf), 0);
+}
+
+TEST(SchipTests, ScrollsInPixelsOfTheResolution) {
+    const std::vector<u8> rom{
+        0x60, 0x00, // 200: V0 = 0
+        0xf0, 0x29, // 202: I = digit V0
+        0xd0, 0x05, // 204: draw at 0, 0
+        0x00, 0xc2, // 206: scroll down 2
+        0x00, 0xfb, // 208: scroll right
+        0x00, 0xfc, // 20A: scroll left
+    };
+    Session run(rom);
+    run.cpu.run(5);
+    const auto &framebuffer = run.cpu.framebuffer();
+    EXPECT_FALSE(framebuffer.is_set(0, 0));
+    EXPECT_FALSE(framebuffer.is_set(0, 2));
+    EXPECT_TRUE(framebuffer.is_set(4, 2));
+    EXPECT_TRUE(framebuffer.is_set(7, 6));
+
+    run.cpu.run(1);
+    EXPECT_TRUE(framebuffer.is_set(0, 2));
+    EXPECT_FALSE(framebuffer.is_set(4, 2));
+}
+
+TEST(SchipTests, BigFontAndFlags) {
+    const std::vector<u8> rom{
+        0x60, 0x07, // 200: V0 = 7
+        0xf0, 0x30, // 202: I = big digit V0
+        0x61, 0x2a, // 204: V1 = 0x2a
+        0xf1, 0x75, // 206: flags = V0..V1
+        0x60, 0x00, // 208: V0 = 0
+        0x61, 0x00, // 20A: V1 = 0
+        0xf1, 0x85, // 20C: V0..V1 = flags
+    };
+    Session run(rom);
+    run.cpu.run(7);
+    EXPECT_EQ(run.cpu.registers().get_index(), big_font_start + 7 * big_bytes_per_ch);
+    EXPECT_EQ(run.cpu.memory().data()[run.cpu.registers().get_index()], 0xff);
+    EXPECT_EQ(run.cpu.flags().at(1), 0x2a);
+    EXPECT_EQ(run.cpu.registers().at(0), 7);
+    EXPECT_EQ(run.cpu.registers().at(1), 0x2a);
+}
+
+TEST(SchipTests, ExitStopsTheMachine) {
+    const std::vector<u8> rom{
+        0x60, 0x01, // 200: V0 = 1
+        0x00, 0xfd, // 202: exit
+        0x60, 0x02, // 204: V0 = 2
+    };
+    Session run(rom);
+    EXPECT_EQ(run.cpu.run(3), 1);
+    EXPECT_EQ(run.cpu.trap().kind, Trap::Exit);
+    EXPECT_EQ(run.cpu.trap().pc, 0x202);
+    EXPECT_EQ(run.cpu.run(1), 0);
+    EXPECT_EQ(run.cpu.registers().at(0), 1);
+}
+
+TEST(SchipTests, EnginesAgree) {
+    auto rom = schip_rom();
+    // part way, still in high resolution, then up to the exit
+    for (unsigned int count : { 12U, 64U }) {
+        Session reference(rom, Dispatch::Switch);
+        auto expected = reference.cpu.run(count);
+        for (auto dispatch : { Dispatch::Threaded, Dispatch::Jit }) {
+            Session run(rom, dispatch);
+            EXPECT_EQ(run.cpu.run(count), expected);
+            EXPECT_EQ(run.cpu.trap().kind, reference.cpu.trap().kind);
+            EXPECT_EQ(run.cpu.registers().get_pc(), reference.cpu.registers().get_pc());
+            EXPECT_EQ(run.cpu.flags(), reference.cpu.flags());
+            expect_same_screen(run.cpu.framebuffer(), reference.cpu.framebuffer());
+        }
+
+        auto lockstep = std::make_unique<Lockstep<4>>(rom);
+        lockstep->run(count);
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            EXPECT_EQ(lockstep->pc(lane), reference.cpu.registers().get_pc());
+            EXPECT_EQ(lockstep->trap(lane), reference.cpu.trap().kind);
+            EXPECT_EQ(lockstep->reg(lane, 0), reference.cpu.registers().at(0));
+            expect_same_screen(lockstep->framebuffer(lane), reference.cpu.framebuffer());
+        }
+    }
+}
+
+TEST(SchipTests, SnapshotsKeepResolutionAndFlags) {
+    auto rom = schip_rom();
+    Session run(rom);
+    run.cpu.run(15);
+    ASSERT_TRUE(run.cpu.framebuffer().is_high_res());
+
+    auto snapshot = std::make_unique<Snapshot>();
+    run.cpu.save(*snapshot);
+    Session restored(rom);
+    restored.cpu.load(*snapshot);
+    EXPECT_EQ(restored.cpu.flags(), run.cpu.flags());
+    expect_same_screen(restored.cpu.framebuffer(), run.cpu.framebuffer());
+
+    EXPECT_EQ(restored.cpu.run(64), run.cpu.run(64));
+    expect_same_screen(restored.cpu.framebuffer(), run.cpu.framebuffer());
+}
+
+TEST(SchipTests, MachineScreenFollowsResolution) {
+    const std::vector<u8> rom{
+        0x00, 0xff, // 200: high res
+        0x60, 0x7f, // 202: V0 = 127
+        0x61, 0x00, // 204: V1 = 0
+        0xf1, 0x29, // 206: I = digit V1
+        0xd0, 0x01, // 208: draw its top row at 127, 127 % 64
+    };
+    Machine machine(rom);
+    EXPECT_EQ(machine.screen().width, chip8_width);
+    machine.step(5);
+    auto screen = machine.screen();
+    EXPECT_EQ(screen.width, schip_width);
+    EXPECT_EQ(screen.height, schip_height);
+    EXPECT_EQ(screen.words_per_row(), 2U);
+    EXPECT_TRUE(screen.is_set(127, 63));
+    EXPECT_FALSE(screen.is_set(126, 63));
+}
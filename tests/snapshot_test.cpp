@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cpu.h>
+#include <null_frontend.h>
+#include <run_ahead.h>
+#include <snapshot.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// damage the stack pointer like a corrupted buffer would, CallStack has no setter
+void set_stack_pointer(Snapshot &snapshot, u8 sp) {
+    std::memcpy(reinterpret_cast<u8 *>(&snapshot.stack) + sizeof(u16) * chip8_stack_depth, &sp, sizeof(sp));
+}
+
+void expect_same_state(const CPU &lhs, const CPU &rhs) {
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        EXPECT_EQ(lhs.registers().at(reg), rhs.registers().at(reg));
+    }
+    EXPECT_EQ(lhs.registers().get_pc(), rhs.registers().get_pc());
+    EXPECT_EQ(lhs.registers().get_index(), rhs.registers().get_index());
+    EXPECT_EQ(lhs.registers().get_timer(), rhs.registers().get_timer());
+    EXPECT_EQ(lhs.stack().sp(), rhs.stack().sp());
+    EXPECT_EQ(lhs.framebuffer().is_high_res(), rhs.framebuffer().is_high_res());
+    EXPECT_TRUE(std::ranges::equal(lhs.framebuffer().words(), rhs.framebuffer().words()));
+}
+} // namespace
+
+TEST(SnapshotTests, LoadResumesWhereSaveLeftOff) {
+    constexpr unsigned int before = 500;
+    constexpr unsigned int after = 1500;
+
+    for (auto dispatch : { Dispatch::Switch, Dispatch::Threaded, Dispatch::Jit }) {
+        NullFrontend frontend;
+        CPU cpu("roms/test_opcode.ch8", frontend, dispatch);
+        cpu.run(before);
+
+        auto snapshot = std::make_unique<Snapshot>();
+        cpu.save(*snapshot);
+        cpu.run(after);
+
+        // a fresh machine picks up the saved one
+        CPU restored("roms/IBM_Logo.ch8", frontend, dispatch);
+        restored.load(*snapshot);
+        restored.run(after);
+        expect_same_state(cpu, restored);
+
+        // and the original rewinds to it
+        cpu.load(*snapshot);
+        cpu.run(after);
+        expect_same_state(cpu, restored);
+    }
+}
+
+TEST(SnapshotTests, RoundTripsThroughBytes) {
+    NullFrontend frontend;
+    CPU cpu("roms/IBM_Logo.ch8", frontend);
+    cpu.run(20);
+
+    auto snapshot = std::make_unique<Snapshot>();
+    cpu.save(*snapshot);
+    auto bytes = snapshot_bytes(*snapshot);
+    std::vector<u8> blob(bytes.begin(), bytes.end());
+
+    auto copy = std::make_unique<Snapshot>();
+    snapshot_from_bytes(blob, *copy);
+    CPU restored("roms/test_opcode.ch8", frontend);
+    restored.load(*copy);
+    expect_same_state(cpu, restored);
+
+    blob.at(4) ^= 0xff; // version
+    EXPECT_THROW(snapshot_from_bytes(blob, *copy), std::runtime_error);
+    blob.pop_back();
+    EXPECT_THROW(snapshot_from_bytes(blob, *copy), std::runtime_error);
+}
+
+TEST(SnapshotTests, RejectsInvalidStates) {
+    NullFrontend frontend;
+    CPU cpu("roms/IBM_Logo.ch8", frontend);
+    cpu.run(20);
+    auto saved = std::make_unique<Snapshot>();
+    cpu.save(*saved);
+    EXPECT_TRUE(CPU::is_valid(*saved));
+    auto probe = std::make_unique<Snapshot>(*saved);
+    set_stack_pointer(*probe, 200);
+    ASSERT_EQ(probe->stack.sp(), 200);
+
+    const std::vector<std::function<void(Snapshot &)>> corruptions{
+        [](Snapshot &snapshot) { set_stack_pointer(snapshot, 200); },
+        [](Snapshot &snapshot) { snapshot.key_pressed = 16; },
+        [](Snapshot &snapshot) { snapshot.key_pressed = -2; },
+        [](Snapshot &snapshot) { snapshot.trap.kind = static_cast<Trap>(0x7f); },
+        [](Snapshot &snapshot) { snapshot.instr_per_sec = 0; },
+        [](Snapshot &snapshot) { snapshot.regs.set_pc(default_memory_size - 1); },
+        [](Snapshot &snapshot) { snapshot.quirks = static_cast<QuirkProfile>(quirk_profile_count); },
+    };
+    for (const auto &corrupt : corruptions) {
+        auto snapshot = std::make_unique<Snapshot>(*saved);
+        corrupt(*snapshot);
+        EXPECT_FALSE(CPU::is_valid(*snapshot));
+        EXPECT_THROW(cpu.load(*snapshot), std::runtime_error);
+    }
+
+    // nothing of a rejected state was applied
+    auto after = std::make_unique<Snapshot>();
+    cpu.save(*after);
+    auto saved_bytes = snapshot_bytes(*saved);
+    auto after_bytes = snapshot_bytes(*after);
+    EXPECT_TRUE(std::ranges::equal(saved_bytes, after_bytes));
+}
+
+TEST(SnapshotTests, RejectsStatesOfOtherQuirks) {
+    NullFrontend frontend;
+    CPU vip("roms/IBM_Logo.ch8", frontend, default_dispatch, QuirkProfile::CosmacVip);
+    vip.run(20);
+    auto snapshot = std::make_unique<Snapshot>();
+    vip.save(*snapshot);
+    EXPECT_EQ(snapshot->quirks, QuirkProfile::CosmacVip);
+
+    CPU chip8("roms/IBM_Logo.ch8", frontend);
+    EXPECT_THROW(chip8.load(*snapshot), std::runtime_error);
+    EXPECT_EQ(chip8.registers().get_pc(), rom_start);
+
+    CPU restored("roms/IBM_Logo.ch8", frontend, default_dispatch, QuirkProfile::CosmacVip);
+    restored.load(*snapshot);
+    expect_same_state(vip, restored);
+}
+
+TEST(SnapshotTests, KeepsIndexPastTheEndOfMemory) {
+    const std::array<u8, 8> rom{
+        0xaf, 0xff, // 200: I = FFF
+        0x60, 0x05, // 202: V0 = 5
+        0xf0, 0x1e, // 204: I += V0
+        0x12, 0x06, // 206: jump 206
+    };
+    NullFrontend frontend;
+    CPU cpu(rom, frontend);
+    cpu.run(4);
+    ASSERT_EQ(cpu.registers().get_index(), 0x1004);
+
+    auto snapshot = std::make_unique<Snapshot>();
+    cpu.save(*snapshot);
+    EXPECT_TRUE(CPU::is_valid(*snapshot));
+    CPU restored(rom, frontend);
+    restored.load(*snapshot);
+    expect_same_state(cpu, restored);
+
+    // run ahead restores the state every frame
+    RunAhead run_ahead(1);
+    EXPECT_NO_THROW(run_ahead.run_frame(restored, frontend));
+    EXPECT_EQ(restored.registers().get_index(), 0x1004);
+}
@@ -0,0 +1,67 @@
+// runs a rom translated by chip8_translate and the interpreter side by side
+// and reports the speed of both
+
+#include <aot.h>
+#include <cpu.h>
+#include <null_frontend.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace {
+constexpr unsigned int default_instructions = 10'000'000;
+
+double run_timed(CPU &cpu, unsigned int instructions) {
+    auto start = std::chrono::steady_clock::now();
+    cpu.run(instructions);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+bool same_state(const CPU &lhs, const CPU &rhs) {
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        if (lhs.registers().at(reg) != rhs.registers().at(reg)) {
+            return false;
+        }
+    }
+    if (lhs.framebuffer().is_high_res() != rhs.framebuffer().is_high_res()) {
+        return false;
+    }
+    for (u8 y = 0; y < lhs.framebuffer().height(); ++y) {
+        for (u8 x = 0; x < lhs.framebuffer().width(); ++x) {
+            if (lhs.framebuffer().is_set(x, y) != rhs.framebuffer().is_set(x, y)) {
+                return false;
+            }
+        }
+    }
+    return lhs.registers().get_pc() == rhs.registers().get_pc() && lhs.registers().get_index() == rhs.registers().get_index();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    auto args = gsl::make_span(argv, argc);
+    auto instructions = default_instructions;
+    if (argc > 1) {
+        instructions = std::stoul(gsl::at(args, 1));
+    }
+
+    NullFrontend interpreted_frontend;
+    CPU interpreted(translated_rom(), interpreted_frontend, Dispatch::Threaded, translated_quirks());
+    auto interpreted_time = run_timed(interpreted, instructions);
+
+    NullFrontend translated_frontend;
+    CPU translated(translated_rom(), translated_frontend, translated_program, translated_quirks());
+    auto translated_time = run_timed(translated, instructions);
+
+    std::cout << "instructions: " << instructions << '\n';
+    std::cout << "interpreter:  " << interpreted_time << " s\n";
+    std::cout << "translated:   " << translated_time << " s\n";
+
+    if (!same_state(interpreted, translated)) {
+        std::cerr << "translated program diverged from the interpreter" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
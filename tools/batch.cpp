@@ -0,0 +1,264 @@
+// chip8_batch: runs the jobs of a manifest headlessly on all cores
+//
+// manifest lines are "rom input_script instructions [quirks]", paths relative
+// to the manifest, '-' for no input script, quirks one of chip8, vip, schip
+// or xochip and '#' starting a comment. Without quirks a job runs with the
+// quirks the rom database has for its rom, and the timers always tick at
+// the speed it has. A job stops early when the machine traps, its line then
+// names the trap and where it happened. Input script lines are
+// "instruction key down|up" with the key in hex.
+
+#include <cpu.h>
+#include <null_frontend.h>
+#include <quirks.h>
+#include <rom_db.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct KeyEvent {
+    unsigned long instruction;
+    u8 key;
+    bool pressed;
+};
+
+struct Job {
+    fs::path rom;
+    std::vector<KeyEvent> input;
+    unsigned long instructions;
+    std::optional<QuirkProfile> quirks; // unset looks the rom up
+};
+
+struct JobResult {
+    u64 hash = 0;
+    std::vector<u64> words; // the screen, words_per_row words per row
+    std::size_t words_per_row = 0;
+    CpuTrap trap;
+    std::string error;
+};
+
+std::vector<KeyEvent> read_input_script(const fs::path &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open input script " + path.string());
+    }
+
+    std::vector<KeyEvent> events;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        unsigned long instruction = 0;
+        unsigned int key = 0;
+        std::string action;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        if (!(fields >> instruction >> std::hex >> key >> action) || key > 0xf || (action != "down" && action != "up")) {
+            throw std::runtime_error("bad input script line: " + line);
+        }
+        events.push_back(KeyEvent{ instruction, static_cast<u8>(key), action == "down" });
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const KeyEvent &lhs, const KeyEvent &rhs) { return lhs.instruction < rhs.instruction; });
+    return events;
+}
+
+std::vector<Job> read_manifest(const fs::path &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open manifest " + path.string());
+    }
+
+    auto base = path.parent_path();
+    std::vector<Job> jobs;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string rom;
+        std::string input;
+        unsigned long instructions = 0;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        if (!(fields >> rom >> input >> instructions)) {
+            throw std::runtime_error("bad manifest line: " + line);
+        }
+        std::optional<QuirkProfile> profile;
+        if (std::string quirks; fields >> quirks) {
+            profile = parse_quirk_profile(quirks);
+            if (!profile) {
+                throw std::runtime_error("unknown quirk profile in manifest line: " + line);
+            }
+        }
+
+        Job job{ base / rom, {}, instructions, profile };
+        if (!fs::is_regular_file(job.rom)) {
+            throw std::runtime_error("cannot open rom " + job.rom.string());
+        }
+        if (input != "-") {
+            job.input = read_input_script(base / input);
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+// FNV-1a over the registers and the screen
+u64 state_hash(const CPU &cpu) {
+    constexpr u64 offset_basis = 0xcbf29ce484222325;
+    constexpr u64 prime = 0x100000001b3;
+
+    u64 hash = offset_basis;
+    auto mix = [&hash](u64 value) {
+        hash ^= value;
+        hash *= prime;
+    };
+
+    const auto &regs = cpu.registers();
+    for (u8 reg = 0; reg < Registers::m_number_of_registers; ++reg) {
+        mix(regs.at(reg));
+    }
+    mix(regs.get_pc());
+    mix(regs.get_index());
+    const auto &framebuffer = cpu.framebuffer();
+    mix(framebuffer.is_high_res() ? 1 : 0);
+    for (u8 y = 0; y < framebuffer.height(); ++y) {
+        for (u8 x = 0; x < framebuffer.width(); ++x) {
+            mix(framebuffer.is_set(x, y) ? 1 : 0);
+        }
+    }
+    return hash;
+}
+
+JobResult run_job(const Job &job, const RomDatabase &database) {
+    JobResult result;
+    try {
+        auto rom = read_rom_file(job.rom);
+        auto info = database.find(rom).value_or(RomInfo{});
+        NullFrontend frontend;
+        CPU cpu(rom, frontend, default_dispatch, job.quirks.value_or(info.quirks));
+        if (info.instr_per_frame > 0) {
+            cpu.set_instr_per_frame(info.instr_per_frame);
+        }
+
+        // virtual time: run up to each key event, no wall clock involved
+        unsigned long executed = 0;
+        for (auto event = job.input.begin(); executed < job.instructions && !cpu.is_trapped(); ) {
+            for (; event != job.input.end() && event->instruction == executed; ++event) {
+                frontend.set_key(event->key, event->pressed);
+            }
+            auto next = event != job.input.end() ? std::min(event->instruction, job.instructions) : job.instructions;
+            // run() counts in unsigned int, longer gaps go in pieces
+            while (executed < next && !cpu.is_trapped()) {
+                auto piece = std::min<unsigned long>(next - executed, std::numeric_limits<unsigned int>::max());
+                cpu.run(static_cast<unsigned int>(piece));
+                executed += piece;
+            }
+        }
+
+        result.trap = cpu.trap();
+        result.hash = state_hash(cpu);
+        auto words = cpu.framebuffer().words();
+        result.words.assign(words.begin(), words.end());
+        result.words_per_row = cpu.framebuffer().words_per_row();
+    } catch (std::exception &e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const auto usage = [] {
+        std::cout << "USAGE: chip8_batch manifest [threads] [--rom-db=file]" << std::endl;
+        return -1;
+    };
+    if (argc < 2) {
+        return usage();
+    }
+
+    auto args = gsl::make_span(argv, argc);
+    unsigned int threads = std::max(1U, std::thread::hardware_concurrency());
+    std::string rom_db;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = gsl::at(args, i);
+        const std::string rom_db_flag = "--rom-db=";
+        if (arg.starts_with(rom_db_flag)) {
+            rom_db = arg.substr(rom_db_flag.size());
+        } else {
+            const auto *end = arg.data() + arg.size();
+            auto [parsed, error] = std::from_chars(arg.data(), end, threads);
+            if (error != std::errc() || parsed != end) {
+                return usage();
+            }
+            threads = std::max(1U, threads);
+        }
+    }
+
+    std::vector<Job> jobs;
+    RomDatabase database;
+    try {
+        if (!rom_db.empty()) {
+            database.load_overrides(rom_db);
+        }
+        jobs = read_manifest(gsl::at(args, 1));
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    // one emulator per job, workers take the next job until none is left
+    std::vector<JobResult> results(jobs.size());
+    std::atomic<std::size_t> next_job{ 0 };
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned int i = 0; i < std::min<std::size_t>(threads, jobs.size()); ++i) {
+            workers.emplace_back([&] {
+                for (auto job = next_job++; job < jobs.size(); job = next_job++) {
+                    results.at(job) = run_job(jobs.at(job), database);
+                }
+            });
+        }
+    }
+
+    int failed = 0;
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        const auto &result = results.at(i);
+        std::cout << "job " << i << ' ' << jobs.at(i).rom.string() << ' ';
+        if (!result.error.empty()) {
+            std::cout << "error: " << result.error << '\n';
+            ++failed;
+            continue;
+        }
+        std::cout << "hash " << std::hex << std::setfill('0') << std::setw(16) << result.hash;
+        if (result.trap.kind != Trap::None) {
+            std::cout << " trap " << trap_name(result.trap.kind) << " at 0x" << std::setw(3) << result.trap.pc;
+        }
+        std::cout << '\n';
+        for (std::size_t word = 0; word < result.words.size(); ++word) {
+            std::cout << std::setw(16) << result.words.at(word) << ((word + 1) % result.words_per_row == 0 ? '\n' : ' ');
+        }
+        std::cout << std::dec;
+    }
+
+    return failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,143 @@
+// chip8_replay: replays a movie recorded with `chip8 ... --record=movie`
+// headlessly as fast as possible and checks it ends on the recorded state
+//
+// exits with -1 if it does not, so a movie of a bug report doubles as a
+// regression test, and the frame rate it prints as a benchmark.
+// --seek=frame prints the state hash at frame, starting from the nearest
+// keyframe. --verify[=threads] replays the segments between keyframes in
+// parallel instead and checks each one ends on the next keyframe.
+
+#include <cpu.h>
+#include <movie.h>
+#include <null_frontend.h>
+#include <ram.h>
+#include <snapshot.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+u64 hash_of(const CPU &cpu) {
+    auto snapshot = std::make_unique<Snapshot>();
+    cpu.save(*snapshot);
+    return state_hash(*snapshot);
+}
+
+void print_hash(u64 hash) {
+    std::cout << "hash " << std::hex << std::setfill('0') << std::setw(16) << hash << std::dec << '\n';
+}
+
+// segments go to workers in order, false for every one that diverged
+std::vector<bool> verify(const Movie &movie, gsl::span<const u8> rom, unsigned int threads) {
+    std::vector<char> ok(movie.segments(), 0);
+    std::atomic<std::size_t> next_segment{ 0 };
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned int i = 0; i < std::min<std::size_t>(threads, movie.segments()); ++i) {
+            workers.emplace_back([&] {
+                for (auto segment = next_segment++; segment < movie.segments(); segment = next_segment++) {
+                    try {
+                        ok.at(segment) = verify_segment(movie, rom, segment) ? 1 : 0;
+                    } catch (std::exception &) {
+                        ok.at(segment) = 0;
+                    }
+                }
+            });
+        }
+    }
+    return { ok.begin(), ok.end() };
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "USAGE: chip8_replay romfile movie [--seek=frame | --verify[=threads]]" << std::endl;
+        return -1;
+    }
+
+    auto args = gsl::make_span(argv, argc);
+    try {
+        auto rom = read_rom_file(gsl::at(args, 1));
+        auto movie = Movie::load(gsl::at(args, 2));
+        if (!movie.is_for(rom)) {
+            std::cerr << "the movie was recorded with another rom" << std::endl;
+            return -1;
+        }
+
+        const std::string mode = argc > 3 ? gsl::at(args, 3) : "";
+        const std::string seek_flag = "--seek=";
+        const std::string verify_flag = "--verify";
+
+        NullFrontend frontend;
+        CPU cpu(rom, frontend, default_dispatch, movie.quirks());
+        auto start = std::chrono::steady_clock::now();
+
+        if (mode.starts_with(seek_flag)) {
+            auto frame = static_cast<u32>(std::stoul(mode.substr(seek_flag.size())));
+            if (frame > movie.frames()) {
+                std::cerr << "the movie has only " << movie.frames() << " frames" << std::endl;
+                return -1;
+            }
+            seek(movie, cpu, frontend, frame);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << "frame " << frame << " in " << elapsed.count() << "s\n";
+            print_hash(hash_of(cpu));
+            return 0;
+        }
+
+        if (mode.starts_with(verify_flag)) {
+            unsigned int threads = std::max(1U, std::thread::hardware_concurrency());
+            if (mode.size() > verify_flag.size()) {
+                threads = std::max(1UL, std::stoul(mode.substr(verify_flag.size() + 1)));
+            }
+            auto ok = verify(movie, rom, threads);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << movie.frames() << " frames in " << ok.size() << " segments in " << elapsed.count() << "s\n";
+
+            int failed = 0;
+            for (std::size_t segment = 0; segment < ok.size(); ++segment) {
+                if (!ok[segment]) {
+                    auto from = movie.keyframes().empty() ? 0 : movie.keyframes()[segment].frame;
+                    std::cout << "segment " << segment << " from frame " << from << " diverged\n";
+                    ++failed;
+                }
+            }
+            return failed == 0 ? 0 : -1;
+        }
+
+        if (!mode.empty()) {
+            std::cerr << "unknown option " << mode << std::endl;
+            return -1;
+        }
+
+        prepare_replay(movie, cpu);
+        replay(movie, cpu, frontend, 0, movie.frames());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        auto hash = hash_of(cpu);
+        std::cout << movie.frames() << " frames in " << elapsed.count() << "s (" << movie.frames() / elapsed.count() << " frames/s)\n";
+        print_hash(hash);
+        if (cpu.is_trapped()) {
+            std::cout << trap_name(cpu.trap().kind) << " at 0x" << std::hex << cpu.trap().pc << std::dec << '\n';
+        }
+        if (hash != movie.final_hash()) {
+            std::cerr << "replay diverged, the recording ended on " << std::hex << std::setfill('0') << std::setw(16) << movie.final_hash() << std::endl;
+            return -1;
+        }
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
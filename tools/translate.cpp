@@ -0,0 +1,508 @@
+// chip8_translate: translates a rom ahead of time into a C++ translation
+// unit defining translated_rom(), translated_quirks() and
+// translated_program() (see aot.h) for one quirk profile
+
+#include <commands.h>
+#include <decoder.h>
+#include <quirks.h>
+#include <ram.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string hex(unsigned int value) {
+    std::ostringstream stream;
+    stream << "0x" << std::hex << std::setw(3) << std::setfill('0') << value;
+    return stream.str();
+}
+
+std::string label(u16 pc) {
+    std::ostringstream stream;
+    stream << "l_" << std::hex << pc;
+    return stream.str();
+}
+
+std::string kind_name(Instr kind) {
+    switch (kind) {
+        case (Instr::NotDecoded):
+            return "NotDecoded";
+        case (Instr::Unknown):
+            return "Unknown";
+        case (Instr::MachineRoutine):
+            return "MachineRoutine";
+        case (Instr::Clear):
+            return "Clear";
+        case (Instr::Return):
+            return "Return";
+        case (Instr::ScrollDown):
+            return "ScrollDown";
+        case (Instr::ScrollRight):
+            return "ScrollRight";
+        case (Instr::ScrollLeft):
+            return "ScrollLeft";
+        case (Instr::Exit):
+            return "Exit";
+        case (Instr::LowRes):
+            return "LowRes";
+        case (Instr::HighRes):
+            return "HighRes";
+        case (Instr::Jump):
+            return "Jump";
+        case (Instr::Call):
+            return "Call";
+        case (Instr::IfRegNotEqualValue):
+            return "IfRegNotEqualValue";
+        case (Instr::IfRegEqualValue):
+            return "IfRegEqualValue";
+        case (Instr::IfRegNotEqualReg):
+            return "IfRegNotEqualReg";
+        case (Instr::SetRegValue):
+            return "SetRegValue";
+        case (Instr::AddToReg):
+            return "AddToReg";
+        case (Instr::Set):
+            return "Set";
+        case (Instr::BitwiseOr):
+            return "BitwiseOr";
+        case (Instr::BitwiseAnd):
+            return "BitwiseAnd";
+        case (Instr::BitwiseXor):
+            return "BitwiseXor";
+        case (Instr::Addition):
+            return "Addition";
+        case (Instr::Subtraction):
+            return "Subtraction";
+        case (Instr::ShiftRight):
+            return "ShiftRight";
+        case (Instr::AltSubtraction):
+            return "AltSubtraction";
+        case (Instr::ShiftLeft):
+            return "ShiftLeft";
+        case (Instr::IfRegEquality):
+            return "IfRegEquality";
+        case (Instr::SetIndex):
+            return "SetIndex";
+        case (Instr::JumpV0Addr):
+            return "JumpV0Addr";
+        case (Instr::RandomNumber):
+            return "RandomNumber";
+        case (Instr::LoadSprite):
+            return "LoadSprite";
+        case (Instr::IfKeyNotPressed):
+            return "IfKeyNotPressed";
+        case (Instr::IfKeyPressed):
+            return "IfKeyPressed";
+        case (Instr::SetVxDelay):
+            return "SetVxDelay";
+        case (Instr::SetVxKey):
+            return "SetVxKey";
+        case (Instr::SetDelay):
+            return "SetDelay";
+        case (Instr::SetBuzzer):
+            return "SetBuzzer";
+        case (Instr::AddVxToIndex):
+            return "AddVxToIndex";
+        case (Instr::SetIndexToHex):
+            return "SetIndexToHex";
+        case (Instr::SetIndexToBigHex):
+            return "SetIndexToBigHex";
+        case (Instr::BcdVx):
+            return "BcdVx";
+        case (Instr::StoreToRam):
+            return "StoreToRam";
+        case (Instr::LoadFromRam):
+            return "LoadFromRam";
+        case (Instr::StoreFlags):
+            return "StoreFlags";
+        case (Instr::LoadFlags):
+            return "LoadFlags";
+    }
+    return "Unknown";
+}
+
+std::string profile_name(QuirkProfile profile) {
+    switch (profile) {
+        case (QuirkProfile::Chip8):
+            return "Chip8";
+        case (QuirkProfile::CosmacVip):
+            return "CosmacVip";
+        case (QuirkProfile::SuperChip):
+            return "SuperChip";
+        case (QuirkProfile::XoChip):
+            return "XoChip";
+    }
+    return "Chip8";
+}
+
+class Translator {
+  public:
+    Translator(gsl::span<const u8> rom, QuirkProfile quirks) : m_memory(rom), m_rom_end(rom_start + rom.size()), m_profile(quirks), m_quirks(quirk_set(quirks)), m_policy("Quirks<QuirkProfile::" + profile_name(quirks) + ">") {}
+
+    void explore() {
+        std::vector<u16> worklist{ rom_start };
+        while (!worklist.empty()) {
+            auto pc = worklist.back();
+            worklist.pop_back();
+            if (!is_in_rom(pc) || m_reachable.contains(pc)) {
+                continue;
+            }
+            m_reachable.insert(pc);
+
+            for (auto next : successors(pc, m_memory.fetch_decoded(pc))) {
+                worklist.push_back(next);
+            }
+        }
+    }
+
+    void emit(std::ostream &out, const std::string &rom_name, gsl::span<const u8> rom) {
+        // bodies first, to know which labels are jumped to
+        std::vector<std::string> bodies;
+        for (auto pc : m_reachable) {
+            bodies.push_back(body(pc, m_memory.fetch_decoded(pc)));
+        }
+
+        out << "// generated by chip8_translate from " << rom_name << ", do not edit\n\n";
+        out << "#include <aot.h>\n#include <commands.h>\n\n#include <array>\n\n";
+
+        out << "namespace {\nconstexpr std::array<u8, " << rom.size() << "> rom{";
+        for (std::size_t i = 0; i < rom.size(); ++i) {
+            out << (i % 16 == 0 ? "\n    " : " ") << "0x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned int>(rom[i]) << std::dec << ",";
+        }
+        out << "\n};\n} // namespace\n\n";
+
+        out << "gsl::span<const u8> translated_rom() noexcept {\n    return rom;\n}\n\n";
+        out << "QuirkProfile translated_quirks() noexcept {\n    return QuirkProfile::" << profile_name(m_profile) << ";\n}\n\n";
+
+        out << "unsigned int translated_program(AotMachine &machine, unsigned int budget) {\n";
+        out << "    auto &regs = machine.regs;\n";
+        out << "    auto *v = regs.get_regs_span().data();\n";
+        out << "    unsigned int executed = 0;\n";
+        out << "    u16 pc = regs.get_pc();\n";
+        out << "    for (;;) {\n";
+        out << "        switch (pc) {\n";
+        auto body_it = bodies.begin();
+        for (auto pc : m_reachable) {
+            out << "            case (" << hex(pc) << "):\n";
+            if (m_labels.contains(pc)) {
+                out << "            " << label(pc) << ":\n";
+            }
+            out << *body_it++;
+        }
+        out << "            default:\n";
+        out << "                regs.set_pc(pc);\n";
+        out << "                return executed;\n";
+        out << "        }\n";
+        out << "    }\n";
+        out << "}\n";
+    }
+
+  private:
+    [[nodiscard]] bool is_in_rom(u16 pc) const {
+        return pc >= rom_start && static_cast<std::size_t>(pc) + 1 < m_rom_end;
+    }
+
+    // addresses execution can continue at after the instruction at pc
+    static std::vector<u16> successors(u16 pc, const Instruction &op) {
+        u16 next = pc + 2;
+        switch (op.kind) {
+            case (Instr::Jump):
+                return { op.nnn };
+            case (Instr::Call):
+                return { op.nnn, next };
+            case (Instr::Return):
+            case (Instr::JumpV0Addr):
+                return {}; // computed, left to the dispatch at runtime
+            case (Instr::Exit):
+                return {};
+            case (Instr::IfRegNotEqualValue):
+            case (Instr::IfRegEqualValue):
+            case (Instr::IfRegNotEqualReg):
+            case (Instr::IfRegEquality):
+            case (Instr::IfKeyNotPressed):
+            case (Instr::IfKeyPressed):
+                return { next, static_cast<u16>(next + 2) };
+            default:
+                return { next };
+        }
+    }
+
+    // continue at pc, falling through when it is the next case
+    std::string flow_to(u16 from, u16 pc) {
+        auto following = m_reachable.upper_bound(from);
+        if (following != m_reachable.end() && *following == pc) {
+            return "                [[fallthrough]];\n";
+        }
+        return jump_to(pc, "                ");
+    }
+
+    std::string jump_to(u16 pc, const std::string &indent) {
+        if (m_reachable.contains(pc)) {
+            m_labels.insert(pc);
+            return indent + "goto " + label(pc) + ";\n";
+        }
+        return indent + "pc = " + hex(pc) + ";\n" + indent + "continue;\n";
+    }
+
+    // continue wherever the instruction left the pc
+    static std::string dispatch() {
+        return "                pc = regs.get_pc();\n                continue;\n";
+    }
+
+    std::string skip_if(u16 pc, const std::string &condition) {
+        u16 next = pc + 2;
+        return "                if (" + condition + ") {\n" + jump_to(next + 2, "                    ") + "                }\n" + flow_to(pc, next);
+    }
+
+    std::string body(u16 pc, const Instruction &op) {
+        auto x = "v[" + hex(op.x) + "]";
+        auto y = "v[" + hex(op.y) + "]";
+        auto vf = "v[" + hex(commands::flag_register) + "]";
+        auto nn = hex(op.nn);
+        auto literal = "Instruction{ .kind = Instr::" + kind_name(op.kind) + ", .x = " + hex(op.x) + ", .y = " + hex(op.y) + ", .n = " + hex(op.n) + ", .nn = " + nn + ", .nnn = " + hex(op.nnn) + " }";
+        u16 next = pc + 2;
+
+        std::string code;
+        // a draw that waits for the timer tick has to stop the engine
+        bool waits = op.kind == Instr::LoadSprite && m_quirks.display_wait;
+        // 00FD traps, which is left to the interpreter to raise
+        if (op.kind == Instr::Unknown || op.kind == Instr::MachineRoutine || op.kind == Instr::Exit || waits) {
+            // not translated, the interpreter executes it
+            return "                regs.set_pc(" + hex(pc) + ");\n                return executed;\n";
+        }
+
+        code += "                if (executed == budget || machine.is_written(" + hex(pc) + ")) {\n";
+        code += "                    regs.set_pc(" + hex(pc) + ");\n";
+        code += "                    return executed;\n";
+        code += "                }\n";
+        code += "                ++executed;\n";
+
+        auto line = [&code](const std::string &statement) {
+            code += "                " + statement + "\n";
+        };
+
+        switch (op.kind) {
+            case (Instr::Clear):
+                line("commands::clear(machine.framebuffer);");
+                break;
+            case (Instr::ScrollDown):
+                line("commands::scroll_down(" + literal + ", machine.framebuffer);");
+                break;
+            case (Instr::ScrollRight):
+                line("commands::scroll_right(machine.framebuffer);");
+                break;
+            case (Instr::ScrollLeft):
+                line("commands::scroll_left(machine.framebuffer);");
+                break;
+            case (Instr::LowRes):
+                line("commands::set_high_res(machine.framebuffer, false);");
+                break;
+            case (Instr::HighRes):
+                line("commands::set_high_res(machine.framebuffer, true);");
+                break;
+            case (Instr::Return):
+                // a trap is left to the interpreter to raise
+                line("if (commands::ret(machine.stack, regs) != Trap::None) {");
+                line("    regs.set_pc(" + hex(pc) + ");");
+                line("    return executed - 1;");
+                line("}");
+                return code + dispatch();
+            case (Instr::Jump):
+                return code + flow_to(pc, op.nnn);
+            case (Instr::Call):
+                line("regs.set_pc(" + hex(next) + ");");
+                line("if (commands::call(" + literal + ", machine.stack, regs) != Trap::None) {");
+                line("    regs.set_pc(" + hex(pc) + ");");
+                line("    return executed - 1;");
+                line("}");
+                return code + flow_to(pc, op.nnn);
+            case (Instr::IfRegNotEqualValue):
+                return code + skip_if(pc, x + " == " + nn);
+            case (Instr::IfRegEqualValue):
+                return code + skip_if(pc, x + " != " + nn);
+            case (Instr::IfRegNotEqualReg):
+                return code + skip_if(pc, x + " == " + y);
+            case (Instr::IfRegEquality):
+                return code + skip_if(pc, x + " != " + y);
+            case (Instr::IfKeyNotPressed):
+                return code + skip_if(pc, "machine.frontend.is_pressed(" + x + ")");
+            case (Instr::IfKeyPressed):
+                return code + skip_if(pc, "!machine.frontend.is_pressed(" + x + ")");
+            case (Instr::SetRegValue):
+                line(x + " = " + nn + ";");
+                break;
+            case (Instr::AddToReg):
+                line(x + " += " + nn + ";");
+                break;
+            case (Instr::Set):
+                line(x + " = " + y + ";");
+                break;
+            case (Instr::BitwiseOr):
+                line(x + " |= " + y + ";");
+                if (m_quirks.vf_reset) {
+                    line(vf + " = 0;");
+                }
+                break;
+            case (Instr::BitwiseAnd):
+                line(x + " &= " + y + ";");
+                if (m_quirks.vf_reset) {
+                    line(vf + " = 0;");
+                }
+                break;
+            case (Instr::BitwiseXor):
+                line(x + " ^= " + y + ";");
+                if (m_quirks.vf_reset) {
+                    line(vf + " = 0;");
+                }
+                break;
+            case (Instr::Addition):
+                line("{");
+                line("    unsigned int sum = " + x + " + " + y + ";");
+                line("    " + x + " = static_cast<u8>(sum);");
+                line("    " + vf + " = sum > 0xff ? 1 : 0;");
+                line("}");
+                break;
+            case (Instr::Subtraction):
+                line("{");
+                line("    u8 flag = " + x + " >= " + y + " ? 1 : 0;");
+                line("    " + x + " = static_cast<u8>(" + x + " - " + y + ");");
+                line("    " + vf + " = flag;");
+                line("}");
+                break;
+            case (Instr::AltSubtraction):
+                line("{");
+                line("    u8 flag = " + y + " >= " + x + " ? 1 : 0;");
+                line("    " + x + " = static_cast<u8>(" + y + " - " + x + ");");
+                line("    " + vf + " = flag;");
+                line("}");
+                break;
+            case (Instr::ShiftRight):
+                line("{");
+                if (m_quirks.shift_vy) {
+                    line("    " + x + " = " + y + ";");
+                }
+                line("    u8 flag = " + x + " & 0x1;");
+                line("    " + x + " >>= 1;");
+                line("    " + vf + " = flag;");
+                line("}");
+                break;
+            case (Instr::ShiftLeft):
+                line("{");
+                if (m_quirks.shift_vy) {
+                    line("    " + x + " = " + y + ";");
+                }
+                line("    u8 flag = " + x + " >> 7;");
+                line("    " + x + " <<= 1;");
+                line("    " + vf + " = flag;");
+                line("}");
+                break;
+            case (Instr::SetIndex):
+                line("regs.set_index(" + hex(op.nnn) + ");");
+                break;
+            case (Instr::JumpV0Addr):
+                line("commands::jump_add_plus_v0<" + m_policy + ">(" + literal + ", regs);");
+                return code + dispatch();
+            case (Instr::RandomNumber):
+                line("commands::random_number(" + literal + ", regs, machine.rng);");
+                break;
+            case (Instr::LoadSprite):
+                line("commands::load_sprite<" + m_policy + ">(" + literal + ", regs, machine.memory, machine.framebuffer);");
+                break;
+            case (Instr::SetVxDelay):
+                line("commands::set_vx_delay(" + literal + ", regs);");
+                break;
+            case (Instr::SetVxKey):
+                // may stay on this instruction until a key is pressed
+                line("regs.set_pc(" + hex(next) + ");");
+                line("commands::set_vx_key(" + literal + ", regs, machine.frontend, machine.key_pressed);");
+                return code + dispatch();
+            case (Instr::SetDelay):
+                line("commands::set_delay(" + literal + ", regs);");
+                break;
+            case (Instr::SetBuzzer):
+                line("commands::set_buzzer(" + literal + ", regs);");
+                break;
+            case (Instr::AddVxToIndex):
+                line("regs.add_index(" + x + ");");
+                break;
+            case (Instr::SetIndexToHex):
+                line("commands::set_index_to_hex(" + literal + ", regs, machine.memory);");
+                break;
+            case (Instr::SetIndexToBigHex):
+                line("commands::set_index_to_big_hex(" + literal + ", regs, machine.memory);");
+                break;
+            case (Instr::BcdVx):
+                line("commands::bcd_vx(" + literal + ", regs, machine.memory);");
+                break;
+            case (Instr::StoreToRam):
+                line("commands::store_to_ram<" + m_policy + ">(" + literal + ", regs, machine.memory);");
+                break;
+            case (Instr::LoadFromRam):
+                line("commands::load_from_ram<" + m_policy + ">(" + literal + ", regs, machine.memory);");
+                break;
+            case (Instr::StoreFlags):
+                line("commands::store_flags(" + literal + ", regs, machine.flags);");
+                break;
+            case (Instr::LoadFlags):
+                line("commands::load_flags(" + literal + ", regs, machine.flags);");
+                break;
+            default:
+                break;
+        }
+        return code + flow_to(pc, next);
+    }
+
+    RAM<> m_memory;
+    std::size_t m_rom_end;
+    QuirkProfile m_profile;
+    QuirkSet m_quirks;
+    std::string m_policy; // the Quirks<> the commands are specialized on
+    std::set<u16> m_reachable;
+    std::set<u16> m_labels;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "USAGE: chip8_translate romfile output.cpp [chip8|vip|schip|xochip]" << std::endl;
+        return -1;
+    }
+
+    auto args = gsl::make_span(argv, argc);
+    fs::path rom_path = gsl::at(args, 1);
+    fs::path output_path = gsl::at(args, 2);
+
+    auto quirks = parse_quirk_profile(argc > 3 ? gsl::at(args, 3) : "chip8");
+    if (!quirks) {
+        std::cerr << "unknown quirk profile " << gsl::at(args, 3) << std::endl;
+        return -1;
+    }
+
+    try {
+        auto rom = read_rom_file(rom_path);
+        Translator translator(rom, *quirks);
+        translator.explore();
+
+        std::ofstream output(output_path);
+        output.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        translator.emit(output, rom_path.filename().string(), rom);
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}